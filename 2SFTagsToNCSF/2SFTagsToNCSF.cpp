@@ -1,7 +1,7 @@
 /*
  * 2SF Tags to NCSF
  * By Naram Qashat (CyberBotX) [cyberbotx@cyberbotx.com]
- * Last modification on 2014-12-08
+ * Last modification on 2026-10-17
  *
  * Version history:
  *   v1.0 - 2013-03-30 - Initial version
@@ -9,12 +9,24 @@
  *   v1.2 - 2012-04-10 - Made it so a file is not overwritten when renaming if
  *                       a duplicate is found.
  *   v1.3 - 2012-12-08 - Minor cleanup of PseudoReadFile to not use a pointer.
+ *   v1.4 - 2026-10-17 - Input files are now memory-mapped when possible
+ *                       instead of being read entirely into memory.
+ *                     - Merged and copied SDATs now share their file data,
+ *                       using less memory.
+ *                     - SDATs are now moved instead of copied when they are
+ *                       merged or stored.
+ *                     - Samples are only decoded when a note is played on
+ *                       them.
+ *                     - The data of an SDAT's files is only kept once, in a
+ *                       buffer shared by the entries and the files.
+ *                     - The files within large SDATs are now read on
+ *                       multiple threads.
  */
 
 #include <tuple>
 #include "NCSF.h"
 
-static const std::string TWOSFTAGSTONCSF_VERSION = "1.3";
+static const std::string TWOSFTAGSTONCSF_VERSION = "1.4";
 
 enum { UNKNOWN, HELP, VERBOSE, EXCLUDETAG, RENAME };
 const option::Descriptor opts[] =
@@ -90,8 +102,9 @@ int main(int argc, char *argv[])
 			}
 			else
 			{
-				PseudoReadFile romFileData(filename);
-				romFileData.GetDataFromVector(programSection.begin() + 8, programSection.end());
+				if (programSection.size() < 8)
+					throw std::runtime_error("This 2SF had no program section!");
+				PseudoReadView romFileData(&programSection[0] + 8, programSection.size() - 8);
 
 				romFileData.pos = 0;
 				romFileData.startOffset = romFileData.GetNextOffset(0, sdatSignatureVector);
@@ -99,7 +112,7 @@ int main(int argc, char *argv[])
 				SDAT sdat;
 				sdat.Read(filename, romFileData, false);
 				std::string filenameMinusPath = GetFilenameFromPath(filename);
-				twoSFSDATs.insert(std::make_pair(filenameMinusPath, sdat));
+				twoSFSDATs.insert(std::make_pair(filenameMinusPath, std::move(sdat)));
 			}
 		}
 		catch (const std::exception &e)
@@ -149,8 +162,7 @@ int main(int argc, char *argv[])
 			// Otherwise it is either an ncsf or an ncsflib
 			else
 			{
-				PseudoReadFile sdatFileData(filename);
-				sdatFileData.GetDataFromVector(programSection.begin(), programSection.end());
+				PseudoReadView sdatFileData(programSection);
 
 				ncsfSDAT.Read(filename, sdatFileData);
 				if (!tags.Empty())
@@ -1,19 +1,57 @@
 /*
  * 2SF to NCSF
  * By Naram Qashat (CyberBotX) [cyberbotx@cyberbotx.com]
- * Last modification on 2014-12-08
+ * Last modification on 2026-10-17
  *
  * Version history:
  *   v1.0 - 2014-10-29 - Initial version
  *   v1.1 - 2012-12-08 - Minor cleanup of PseudoReadFile to not use a pointer.
+ *   v1.2 - 2026-10-17 - Input files are now memory-mapped when possible
+ *                       instead of being read entirely into memory.
+ *                     - The SDAT is now compressed as it is written when
+ *                       creating NCSFs, using less memory.
+ *                     - Faster writing of SDATs.
+ *                     - Faster detection of duplicate files when stripping
+ *                       SDATs.
+ *                     - Merged and copied SDATs now share their file data,
+ *                       using less memory.
+ *                     - SDATs are now moved instead of copied when they are
+ *                       merged or stored.
+ *                     - Samples are only decoded when a note is played on
+ *                       them.
+ *                     - The data of an SDAT's files is only kept once, in a
+ *                       buffer shared by the entries and the files.
+ *                     - Sped up the removal of duplicate and excluded files
+ *                       from SDATs with many files.
+ *                     - The files within large SDATs are now read on
+ *                       multiple threads.
+ *                     - Removed a mutex lock from every SSEQ command while
+ *                       timing.
+ *                     - Timing now returns as soon as a sequence's length is
+ *                       found instead of polling every 150 ms, so timing a
+ *                       sequence no longer costs a minimum of 150-300 ms.
+ *                     - Sequences are now decoded once before timing,
+ *                       instead of their bytes being read again each time a
+ *                       command is run.
+ *                     - Ticks where no commands would run are skipped over
+ *                       when timing a sequence without its notes.
+ *                     - Added an option to time sequences by finding when
+ *                       they repeat themselves exactly, giving the intro and
+ *                       loop lengths.
+ *                     - Faster detection of the silence at the end of one-
+ *                       shot sequences, skipping over ticks where no channel
+ *                       can be heard.
+ *                     - Sample positions are kept in fixed-point when timing
+ *                       one-shot sequences, so the results no longer depend
+ *                       on how the program was compiled.
  */
 
 #include <tuple>
 #include "NCSF.h"
 
-static const std::string TWOSFTONCSF_VERSION = "1.1";
+static const std::string TWOSFTONCSF_VERSION = "1.2";
 
-enum { UNKNOWN, HELP, VERBOSE, TIME, FADELOOP, FADEONESHOT, EXCLUDETAG };
+enum { UNKNOWN, HELP, VERBOSE, TIME, FADELOOP, FADEONESHOT, EXACTLOOPS, EXCLUDETAG };
 const option::Descriptor opts[] =
 {
 	option::Descriptor(UNKNOWN, 0, "", "", option::Arg::None, "2SF to NCSF v" + TWOSFTONCSF_VERSION + "\nBy Naram Qashat (CyberBotX) [cyberbotx@cyberbotx.com]\n\n"
@@ -27,6 +65,8 @@ const option::Descriptor opts[] =
 		"  --time,-t \tCalculate time on each track to the number of loops given. Defaults to 2 loops. 0 will disable timing."),
 	option::Descriptor(FADELOOP, 0, "l", "fade-loop", RequireNumericArgument, "  --fade-loop,-l \tSet the fade time for looping tracks, in seconds, defaults to 10."),
 	option::Descriptor(FADEONESHOT, 0, "o", "fade-one-shot", RequireNumericArgument, "  --fade-one-shot,-o \tSet the fade time for one-shot tracks, in seconds, defaults to 0."),
+	option::Descriptor(EXACTLOOPS, 0, "e", "exact-loops", option::Arg::None,
+		"  --exact-loops,-e \tWhen timing, also look for the sequence repeating itself exactly, to time sequences that loop without jumping back to the start of the loop."),
 	option::Descriptor(EXCLUDETAG, 0, "x", "exclude", RequireArgument, "  --exclude=<tag> \v         -x <tag> \tExclude the given tag from the tags to copy."),
 	option::Descriptor(UNKNOWN, 0, "", "", option::Arg::None,
 		"\nThis tool only works with 2SF sets created with Caitsith2's Legacy of Ys driver, and not older sets such as those using the Yoshi's Island DS driver."
@@ -108,8 +148,9 @@ int main(int argc, char *argv[])
 			}
 			else
 			{
-				PseudoReadFile romFileData(filename);
-				romFileData.GetDataFromVector(programSection.begin() + 8, programSection.end());
+				if (programSection.size() < 8)
+					throw std::runtime_error("This 2SF had no program section!");
+				PseudoReadView romFileData(&programSection[0] + 8, programSection.size() - 8);
 
 				char gameNameArray[12];
 				romFileData.ReadLE(gameNameArray);
@@ -123,7 +164,7 @@ int main(int argc, char *argv[])
 				SDAT sdat;
 				sdat.Read(filename, romFileData, false);
 				std::string filenameMinusPath = GetFilenameFromPath(filename);
-				twoSFSDATs.insert(std::make_pair(filenameMinusPath, sdat));
+				twoSFSDATs.insert(std::make_pair(filenameMinusPath, std::move(sdat)));
 				if (ncsflibFilename.empty() && tags.Empty())
 				{
 					size_t dot = filenameMinusPath.rfind('.');
@@ -173,7 +214,7 @@ int main(int argc, char *argv[])
 		SDAT newSDAT = sdat.MakeFromSSEQ(std::get<0>(twoSF.second));
 		newSDAT.filename = stringify(sdatNumber++ + 1);
 		newSDAT.infoSection.SEQrecord.entries[0].sdatNumber = twoSF.first;
-		finalSDAT += newSDAT;
+		finalSDAT += std::move(newSDAT);
 	});
 
 	finalSDAT.count = 1;
@@ -196,15 +237,11 @@ int main(int argc, char *argv[])
 	if (options[VERBOSE])
 		std::cout << "Output will go to " << NCSFDirectory << "\n";
 
-	// Create vector data for SDAT
-	PseudoWrite sdatData;
-	finalSDAT.Write(sdatData);
-
 	bool singleNCSF = finalSDAT.infoSection.SEQrecord.count == 1;
 	if (!singleNCSF)
 	{
 		// Make NCSFLIB if we are creating more than one NCSF
-		MakeNCSF(NCSFDirectory + "/" + ncsflibFilename, std::vector<uint8_t>(), sdatData.vector->data);
+		MakeNCSF(NCSFDirectory + "/" + ncsflibFilename, std::vector<uint8_t>(), finalSDAT);
 		if (options[VERBOSE])
 			std::cout << "Created " << ncsflibFilename << "\n";
 	}
@@ -225,16 +262,15 @@ int main(int argc, char *argv[])
 		std::string filename = GetFilenameFromPath(origFilename);
 		size_t dot = filename.rfind('.');
 		filename = filename.substr(0, dot) + (singleNCSF ? ".ncsf" : ".minincsf");
-		std::vector<uint8_t> programData;
-		if (singleNCSF)
-			programData = sdatData.vector->data;
-
 		auto reservedData = IntToLEVector<uint32_t>(i);
 
 		if (numberOfLoops)
-			GetTime(filename, &finalSDAT, finalSDAT.infoSection.SEQrecord.entries[i].sseq, tags, !!options[VERBOSE], numberOfLoops, fadeLoop, fadeOneShot);
+			GetTime(filename, &finalSDAT, finalSDAT.infoSection.SEQrecord.entries[i].sseq, tags, !!options[VERBOSE], numberOfLoops, fadeLoop, fadeOneShot, !!options[EXACTLOOPS]);
 
-		MakeNCSF(NCSFDirectory + "/" + filename, reservedData, programData, tags.GetTags());
+		if (singleNCSF)
+			MakeNCSF(NCSFDirectory + "/" + filename, reservedData, finalSDAT, tags.GetTags());
+		else
+			MakeNCSF(NCSFDirectory + "/" + filename, reservedData, std::vector<uint8_t>(), tags.GetTags());
 		if (options[VERBOSE])
 			std::cout << "Created " << filename << "\n";
 	}
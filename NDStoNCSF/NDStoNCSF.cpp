@@ -1,7 +1,7 @@
 /*
  * NDS to NCSF
  * By Naram Qashat (CyberBotX) [cyberbotx@cyberbotx.com]
- * Last modification on 2014-12-09
+ * Last modification on 2026-10-17
  *
  * Version history:
  *   v1.0 - 2013-03-25 - Initial version
@@ -29,15 +29,59 @@
  *   v1.7 - 2014-12-09 - Added functionality to strip the SBNKs and SWARs of
  *                       the SDAT prior to saving it.
  *                     - Minor cleanup of PseudoReadFile to not use a pointer.
+ *   v1.8 - 2026-10-17 - Input files are now memory-mapped when possible
+ *                       instead of being read entirely into memory.
+ *                     - Faster searching for SDATs within the ROM.
+ *                     - The SDAT is now compressed as it is written when
+ *                       creating NCSFs, using less memory.
+ *                     - Faster writing of SDATs.
+ *                     - Faster detection of duplicate files when stripping
+ *                       SDATs.
+ *                     - Merged and copied SDATs now share their file data,
+ *                       using less memory.
+ *                     - SDATs are now moved instead of copied when they are
+ *                       merged or stored.
+ *                     - Samples are only decoded when a note is played on
+ *                       them.
+ *                     - The data of an SDAT's files is only kept once, in a
+ *                       buffer shared by the entries and the files.
+ *                     - Sped up the removal of duplicate and excluded files
+ *                       from SDATs with many files.
+ *                     - The files within large SDATs are now read on
+ *                       multiple threads.
+ *                     - The SDATs within a ROM are now read at the same time
+ *                       and merged in one step.
+ *                     - Sped up matching SSEQs against large SMAPs and many
+ *                       include/exclude rules.
+ *                     - Removed a mutex lock from every SSEQ command while
+ *                       timing.
+ *                     - Timing now returns as soon as a sequence's length is
+ *                       found instead of polling every 150 ms, so timing a
+ *                       sequence no longer costs a minimum of 150-300 ms.
+ *                     - Sequences are now decoded once before timing,
+ *                       instead of their bytes being read again each time a
+ *                       command is run.
+ *                     - Ticks where no commands would run are skipped over
+ *                       when timing a sequence without its notes.
+ *                     - Added an option to time sequences by finding when
+ *                       they repeat themselves exactly, giving the intro and
+ *                       loop lengths.
+ *                     - Faster detection of the silence at the end of one-
+ *                       shot sequences, skipping over ticks where no channel
+ *                       can be heard.
+ *                     - Sample positions are kept in fixed-point when timing
+ *                       one-shot sequences, so the results no longer depend
+ *                       on how the program was compiled.
  */
 
 #include <iomanip>
 #include "NCSF.h"
+#include "Parallel.h"
 #include "TimerTrack.h"
 
-static const std::string NDSTONCSF_VERSION = "1.7";
+static const std::string NDSTONCSF_VERSION = "1.8";
 
-enum { UNKNOWN, HELP, VERBOSE, TIME, FADELOOP, FADEONESHOT, EXCLUDE, INCLUDE, AUTO, CREATE_SMAP, USE_SMAP, NOCOPY };
+enum { UNKNOWN, HELP, VERBOSE, TIME, FADELOOP, FADEONESHOT, EXACTLOOPS, EXCLUDE, INCLUDE, AUTO, CREATE_SMAP, USE_SMAP, NOCOPY };
 const option::Descriptor opts[] =
 {
 	option::Descriptor(UNKNOWN, 0, "", "", option::Arg::None, "NDS to NCSF v" + NDSTONCSF_VERSION + "\nBy Naram Qashat (CyberBotX) [cyberbotx@cyberbotx.com]\n\n"
@@ -52,6 +96,8 @@ const option::Descriptor opts[] =
 		"  --time,-t \tCalculate time on each track to the number of loops given. Defaults to 2 loops. 0 will disable timing."),
 	option::Descriptor(FADELOOP, 0, "l", "fade-loop", RequireNumericArgument, "  --fade-loop,-l \tSet the fade time for looping tracks, in seconds, defaults to 10."),
 	option::Descriptor(FADEONESHOT, 0, "o", "fade-one-shot", RequireNumericArgument, "  --fade-one-shot,-o \tSet the fade time for one-shot tracks, in seconds, defaults to 0."),
+	option::Descriptor(EXACTLOOPS, 0, "e", "exact-loops", option::Arg::None,
+		"  --exact-loops,-e \tWhen timing, also look for the sequence repeating itself exactly, to time sequences that loop without jumping back to the start of the loop."),
 	option::Descriptor(EXCLUDE, 0, "x", "exclude", RequireArgument,
 		"  --exclude=<filename> \v         -x <filename> \tExclude the given filename from the final SDAT. May use * and ? wildcards."),
 	option::Descriptor(INCLUDE, 0, "i", "include", RequireArgument,
@@ -82,7 +128,7 @@ const option::Descriptor opts[] =
 };
 
 // This will compare the data of 2 SSEQs, ignoring the value of patches as those may have been changed from the originals.
-static bool CompareSSEQData(const std::vector<uint8_t> &dataA, const std::vector<uint8_t> &dataB)
+static bool CompareSSEQData(const SharedBytes &dataA, const SharedBytes &dataB)
 {
 	auto patchesA = TimerTrack::GetPatches(dataA), patchesB = TimerTrack::GetPatches(dataB);
 	size_t patchCount = patchesA.first.size();
@@ -120,6 +166,23 @@ static bool CompareSSEQData(const std::vector<uint8_t> &dataA, const std::vector
 	return true;
 }
 
+template<typename T> static inline void SetSDATNumber(INFORecord<T> &record, const std::string &sdatNumber)
+{
+	for (size_t i = 0, entries = record.entries.size(); i < entries; ++i)
+		if (record.entryOffsets[i]) // Empty entries were not given a number
+			record.entries[i].sdatNumber = sdatNumber;
+}
+
+// Changes the number an SDAT was read with, for when an SDAT before it in the ROM could not be read
+static void SetSDATNumber(SDAT &sdat, const std::string &sdatNumber)
+{
+	sdat.filename = sdatNumber;
+	SetSDATNumber(sdat.infoSection.SEQrecord, sdatNumber);
+	SetSDATNumber(sdat.infoSection.BANKrecord, sdatNumber);
+	SetSDATNumber(sdat.infoSection.WAVEARCrecord, sdatNumber);
+	SetSDATNumber(sdat.infoSection.PLAYERrecord, sdatNumber);
+}
+
 typedef std::multimap<std::string, SSEQ> OldSDATFilesMap;
 
 int main(int argc, char *argv[])
@@ -217,8 +280,7 @@ int main(int argc, char *argv[])
 							if (sdatVector.empty())
 								throw std::runtime_error("Program section for " + *curr + " was empty.");
 
-							PseudoReadFile sdatFileData(*curr);
-							sdatFileData.GetDataFromVector(sdatVector.begin(), sdatVector.end());
+							PseudoReadView sdatFileData(sdatVector);
 
 							SDAT sdat;
 							sdat.Read(*curr, sdatFileData);
@@ -277,29 +339,53 @@ int main(int argc, char *argv[])
 		if (options[VERBOSE])
 			std::cout << "Searching for SDATs...\n";
 
-		uint8_t sdatSignature[] = { 0x53, 0x44, 0x41, 0x54, 0xFF, 0xFE, 0x00, 0x01 };
-		std::vector<uint8_t> sdatSignatureVector(sdatSignature, sdatSignature + 8);
-		int32_t sdatOffset, sdatNumber = 0;
-		uint32_t previousOffset = 0;
-		while ((sdatOffset = fileData.GetNextOffset(previousOffset, sdatSignatureVector)) != -1)
+		auto sdatOffsets = SDAT::FindSDATs(fileData);
+		size_t numberOfSDATs = sdatOffsets.size();
+
+		// The SDATs are all read at once, the ones that could not be read are skipped afterwards.
+		// The processors are split between the SDATs, so the threads each SDAT reads its files on
+		// don't add up to more than there are processors.
+		auto sdats = std::vector<SDAT>(numberOfSDATs);
+		auto sdatWasRead = std::vector<uint8_t>(numberOfSDATs, 0);
+		size_t processorCount = GetProcessorCount();
+		size_t sdatThreads = std::max<size_t>(1, std::min(processorCount, numberOfSDATs));
+		size_t fileThreads = std::max<size_t>(1, processorCount / sdatThreads);
+		ParallelFor(numberOfSDATs, sdatThreads, [&](size_t i)
 		{
 			try
 			{
-				fileData.pos = 0;
-				fileData.startOffset = sdatOffset;
-				SDAT sdat;
-				sdat.Read(stringify(sdatNumber++ + 1), fileData);
-				finalSDAT += sdat;
-				if (options[VERBOSE])
-					std::cout << "Found SDAT with " << sdat.infoSection.SEQrecord.actualCount << " SSEQ" << (sdat.infoSection.SEQrecord.actualCount == 1 ? "" : "s") << ".\n";
+				PseudoReadView sdatFileData = fileData;
+				sdatFileData.pos = 0;
+				sdatFileData.startOffset = sdatOffsets[i];
+				// The files are read even when only creating an SMAP, so that the same SDATs fail to read, and are numbered the same, as when the SMAP is used
+				sdats[i].Read(stringify(i + 1), sdatFileData, true, true, fileThreads);
+				sdatWasRead[i] = 1;
 			}
 			catch (const std::exception &)
 			{
-				--sdatNumber;
 			}
-			fileData.startOffset = 0;
-			previousOffset = sdatOffset + 1;
+		});
+
+		// The SDATs are numbered by how many were read before them
+		int32_t sdatNumber = 0;
+		std::vector<SDAT> readSDATs;
+		readSDATs.reserve(numberOfSDATs);
+		for (size_t i = 0; i < numberOfSDATs; ++i)
+		{
+			if (!sdatWasRead[i])
+				continue;
+			auto &sdat = sdats[i];
+			if (static_cast<size_t>(++sdatNumber) != i + 1)
+				SetSDATNumber(sdat, stringify(sdatNumber));
+			if (options[VERBOSE])
+			{
+				uint32_t SSEQCount = sdat.infoSection.SEQrecord.actualCount;
+				std::cout << "Found SDAT with " << SSEQCount << " SSEQ" << (SSEQCount == 1 ? "" : "s") << ".\n";
+			}
+			readSDATs.push_back(std::move(sdat));
 		}
+		sdats.clear();
+		finalSDAT.Merge(std::move(readSDATs));
 
 		// Fail if we do not have any SSEQs (which could also mean that there were no SDATs in the ROM or it wasn't an NDS ROM)
 		if (!finalSDAT.infoSection.SEQrecord.count)
@@ -355,6 +441,9 @@ int main(int argc, char *argv[])
 			return 0;
 		}
 
+		// The rules are prepared once for the loops below, anything added to includesAndExcludes has to be added to it as well
+		KeepMatcher keepMatcher(includesAndExcludes);
+
 		if (options[USE_SMAP])
 		{
 			// First, process the SMAP-like file
@@ -382,6 +471,7 @@ int main(int argc, char *argv[])
 					sdatNum += "/";
 				}
 				includesAndExcludes.push_back(KeepInfo(sdatNum + label, KEEP_INCLUDE));
+				keepMatcher.Add(includesAndExcludes.back());
 			} while (!smapFile.eof());
 
 			// Second, mark all entries not included from the SMAP as being excluded
@@ -390,11 +480,14 @@ int main(int argc, char *argv[])
 				if (!finalSDAT.infoSection.SEQrecord.entryOffsets[i]) // Skip empty offsets
 					continue;
 
-				KeepType keep = IncludeFilename(finalSDAT.infoSection.SEQrecord.entries[i].sseq->origFilename,
-					finalSDAT.infoSection.SEQrecord.entries[i].sdatNumber, includesAndExcludes);
+				KeepType keep = keepMatcher.Match(finalSDAT.infoSection.SEQrecord.entries[i].sseq->origFilename,
+					finalSDAT.infoSection.SEQrecord.entries[i].sdatNumber);
 
 				if (keep == KEEP_NEITHER)
+				{
 					includesAndExcludes.push_back(KeepInfo(finalSDAT.infoSection.SEQrecord.entries[i].FullFilename(sdatNumber > 1), KEEP_EXCLUDE));
+					keepMatcher.Add(includesAndExcludes.back());
+				}
 			}
 		}
 
@@ -410,7 +503,7 @@ int main(int argc, char *argv[])
 				std::string filename = finalSDAT.infoSection.SEQrecord.entries[i].sseq->origFilename,
 					fullFilename = finalSDAT.infoSection.SEQrecord.entries[i].FullFilename(sdatNumber > 1);
 
-				KeepType keep = IncludeFilename(filename, finalSDAT.infoSection.SEQrecord.entries[i].sdatNumber, includesAndExcludes);
+				KeepType keep = keepMatcher.Match(filename, finalSDAT.infoSection.SEQrecord.entries[i].sdatNumber);
 
 				// This file was neither included or excluded on the command line, we need to check if it already existed in the old SDAT
 				if (keep == KEEP_NEITHER)
@@ -459,7 +552,7 @@ int main(int argc, char *argv[])
 				if (sdatNumber > 1)
 					verboseFilename += " (from SDAT #" + finalSDAT.infoSection.SEQrecord.entries[i].sdatNumber + ")";
 
-				KeepType keep = IncludeFilename(filename, finalSDAT.infoSection.SEQrecord.entries[i].sdatNumber, includesAndExcludes);
+				KeepType keep = keepMatcher.Match(filename, finalSDAT.infoSection.SEQrecord.entries[i].sdatNumber);
 
 				if (keep == KEEP_EXCLUDE)
 					std::cout << verboseFilename << " was excluded on the command line.\n";
@@ -477,6 +570,7 @@ int main(int argc, char *argv[])
 						{
 							std::cout << verboseFilename << " was excluded automatically.\n";
 							includesAndExcludes.push_back(KeepInfo(fullFilename, KEEP_EXCLUDE));
+							keepMatcher.Add(includesAndExcludes.back());
 						}
 					}
 					else
@@ -490,7 +584,10 @@ int main(int argc, char *argv[])
 								input[0] = std::tolower(input[0]);
 						} while (!input.empty() && input[0] != 'y' && input[0] != 'n');
 						if ((input.empty() && !defaultToKeep) || (!input.empty() && input[0] == 'n'))
+						{
 							includesAndExcludes.push_back(KeepInfo(fullFilename, KEEP_EXCLUDE));
+							keepMatcher.Add(includesAndExcludes.back());
+						}
 					}
 				}
 			}
@@ -500,10 +597,6 @@ int main(int argc, char *argv[])
 		finalSDAT.StripBanksAndWaveArcs();
 		finalSDAT.Strip(IncOrExc(), options[VERBOSE].count() > 1);
 
-		// Create vector data for SDAT
-		PseudoWrite sdatData;
-		finalSDAT.Write(sdatData);
-
 		if (finalSDAT.infoSection.SEQrecord.entries.size() == 1)
 		{
 			// Make single NCSF
@@ -520,9 +613,9 @@ int main(int argc, char *argv[])
 			auto reservedData = IntToLEVector<uint32_t>(0);
 
 			if (numberOfLoops)
-				GetTime(ncsfFilename, &finalSDAT, finalSDAT.infoSection.SEQrecord.entries[0].sseq, tags, !!options[VERBOSE], numberOfLoops, fadeLoop, fadeOneShot);
+				GetTime(ncsfFilename, &finalSDAT, finalSDAT.infoSection.SEQrecord.entries[0].sseq, tags, !!options[VERBOSE], numberOfLoops, fadeLoop, fadeOneShot, !!options[EXACTLOOPS]);
 
-			MakeNCSF(dirName + "/" + ncsfFilename, reservedData, sdatData.vector->data, tags.GetTags());
+			MakeNCSF(dirName + "/" + ncsfFilename, reservedData, finalSDAT, tags.GetTags());
 			if (options[VERBOSE])
 				std::cout << "Created " << ncsfFilename << "\n";
 		}
@@ -556,7 +649,7 @@ int main(int argc, char *argv[])
 
 			// Make NCSFLIB
 			std::string ncsflibFilename = gameSerial + ".ncsflib";
-			MakeNCSF(dirName + "/" + ncsflibFilename, std::vector<uint8_t>(), sdatData.vector->data);
+			MakeNCSF(dirName + "/" + ncsflibFilename, std::vector<uint8_t>(), finalSDAT);
 			if (options[VERBOSE])
 				std::cout << "Created " << ncsflibFilename << "\n";
 
@@ -595,7 +688,7 @@ int main(int argc, char *argv[])
 					minincsfFilename = filenames[fullFilename];
 
 				if (numberOfLoops)
-					GetTime(minincsfFilename, &finalSDAT, finalSDAT.infoSection.SEQrecord.entries[i].sseq, thisTags, !!options[VERBOSE], numberOfLoops, fadeLoop, fadeOneShot);
+					GetTime(minincsfFilename, &finalSDAT, finalSDAT.infoSection.SEQrecord.entries[i].sseq, thisTags, !!options[VERBOSE], numberOfLoops, fadeLoop, fadeOneShot, !!options[EXACTLOOPS]);
 
 				MakeNCSF(dirName + "/" + minincsfFilename, reservedData, std::vector<uint8_t>(), thisTags.GetTags());
 				if (options[VERBOSE])
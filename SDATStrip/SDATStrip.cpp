@@ -1,7 +1,7 @@
 /*
  * SDAT Strip
  * By Naram Qashat (CyberBotX) [cyberbotx@cyberbotx.com]
- * Last modification on 2014-10-25
+ * Last modification on 2026-10-17
  *
  * NOTE: This version has been superceded by NDS to NCSF instead.
  *
@@ -12,12 +12,33 @@
  *                     - Copied NDS to NCSF's include/exclude handling to here.
  *   v1.2 - 2014-10-25 - Save the PLAYER blocks in the SDATs as opposed to
  *                       stripping them.
+ *   v1.3 - 2026-10-17 - Input files are now memory-mapped when possible
+ *                       instead of being read entirely into memory.
+ *                     - Faster writing of SDATs.
+ *                     - Faster detection of duplicate files when stripping
+ *                       SDATs.
+ *                     - Merged and copied SDATs now share their file data,
+ *                       using less memory.
+ *                     - SDATs are now moved instead of copied when they are
+ *                       merged or stored.
+ *                     - SDATs are read without parsing their files when only
+ *                       their tables are needed.
+ *                     - Samples are only decoded when a note is played on
+ *                       them.
+ *                     - The data of an SDAT's files is only kept once, in a
+ *                       buffer shared by the entries and the files.
+ *                     - Sped up the removal of duplicate and excluded files
+ *                       from SDATs with many files.
+ *                     - The files within large SDATs are now read on
+ *                       multiple threads.
+ *                     - Sped up matching SSEQs against large SMAPs and many
+ *                       include/exclude rules.
  */
 
 #include <map>
 #include "SDAT.h"
 
-static const std::string SDATSTRIP_VERSION = "1.2";
+static const std::string SDATSTRIP_VERSION = "1.3";
 
 enum { UNKNOWN, HELP, VERBOSE, FORCE, EXCLUDE, INCLUDE };
 const option::Descriptor opts[] =
@@ -98,9 +119,10 @@ int main(int argc, char *argv[])
 			PseudoReadFile fileData;
 			fileData.GetDataFromFile(inputFilenames[i]);
 
+			// Stripping only needs the raw data of the files, so they aren't read
 			SDAT sdat;
-			sdat.Read(inputFilenames[i], fileData);
-			finalSDAT += sdat;
+			sdat.Read(inputFilenames[i], fileData, true, false);
+			finalSDAT += std::move(sdat);
 			std::cout << "Appended " << inputFilenames[i] << " to final SDAT.\n";
 		}
 		catch (const std::exception &e)
@@ -127,6 +149,7 @@ int main(int argc, char *argv[])
 		PseudoWrite ofile(&file);
 
 		finalSDAT.Write(ofile);
+		ofile.Flush();
 		std::cout << "Output written to " << outputFilename << "\n";
 	}
 	catch (const std::exception &e)
@@ -1,7 +1,7 @@
 /*
  * SDAT to NCSF
  * By Naram Qashat (CyberBotX) [cyberbotx@cyberbotx.com]
- * Last modification on 2014-12-08
+ * Last modification on 2026-10-17
  *
  * NOTE: This version has been superceded by NDS to NCSF instead.  It also lacks
  *       some of the features that are in NDS to NCSF.
@@ -13,13 +13,42 @@
  *   v1.2 - 2014-10-15 - Improved timing system by implementing the random,
  *                       variable, and conditional SSEQ commands.
  *   v1.3 - 2014-12-08 - Minor cleanup of PseudoReadFile to not use a pointer.
+ *   v1.4 - 2026-10-17 - Input files are now memory-mapped when possible
+ *                       instead of being read entirely into memory.
+ *                     - The SDAT is now compressed as it is written when
+ *                       creating NCSFs, using less memory.
+ *                     - Samples are only decoded when a note is played on
+ *                       them.
+ *                     - The data of an SDAT's files is only kept once, in a
+ *                       buffer shared by the entries and the files.
+ *                     - The files within large SDATs are now read on
+ *                       multiple threads.
+ *                     - Removed a mutex lock from every SSEQ command while
+ *                       timing.
+ *                     - Timing now returns as soon as a sequence's length is
+ *                       found instead of polling every 150 ms, so timing a
+ *                       sequence no longer costs a minimum of 150-300 ms.
+ *                     - Sequences are now decoded once before timing,
+ *                       instead of their bytes being read again each time a
+ *                       command is run.
+ *                     - Ticks where no commands would run are skipped over
+ *                       when timing a sequence without its notes.
+ *                     - Added an option to time sequences by finding when
+ *                       they repeat themselves exactly, giving the intro and
+ *                       loop lengths.
+ *                     - Faster detection of the silence at the end of one-
+ *                       shot sequences, skipping over ticks where no channel
+ *                       can be heard.
+ *                     - Sample positions are kept in fixed-point when timing
+ *                       one-shot sequences, so the results no longer depend
+ *                       on how the program was compiled.
  */
 
 #include "NCSF.h"
 
-static const std::string SDATTONCSF_VERSION = "1.3";
+static const std::string SDATTONCSF_VERSION = "1.4";
 
-enum { UNKNOWN, HELP, VERBOSE, TIME, FADELOOP, FADEONESHOT };
+enum { UNKNOWN, HELP, VERBOSE, TIME, FADELOOP, FADEONESHOT, EXACTLOOPS };
 const option::Descriptor opts[] =
 {
 	option::Descriptor(UNKNOWN, 0, "", "", option::Arg::None, "SDAT to NCSF v" + SDATTONCSF_VERSION + "\nBy Naram Qashat (CyberBotX) [cyberbotx@cyberbotx.com]\n\n"
@@ -34,6 +63,8 @@ const option::Descriptor opts[] =
 		"  --time,-t \tCalculate time on each track to the number of loops given. Defaults to 2 loops. 0 will disable timing."),
 	option::Descriptor(FADELOOP, 0, "l", "fade-loop", RequireNumericArgument, "  --fade-loop,-l \tSet the fade time for looping tracks, in seconds, defaults to 10."),
 	option::Descriptor(FADEONESHOT, 0, "o", "fade-one-shot", RequireNumericArgument, "  --fade-one-shot,-o \tSet the fade time for one-shot tracks, in seconds, defaults to 0."),
+	option::Descriptor(EXACTLOOPS, 0, "e", "exact-loops", option::Arg::None,
+		"  --exact-loops,-e \tWhen timing, also look for the sequence repeating itself exactly, to time sequences that loop without jumping back to the start of the loop."),
 	option::Descriptor(UNKNOWN, 0, "", "", option::Arg::None, "\nVerbose output will output the NCSFs created.\n\nTiming uses code based on FeOS Sound System by fincs."),
 	option::Descriptor()
 };
@@ -102,9 +133,9 @@ int main(int argc, char *argv[])
 			auto reservedData = IntToLEVector<uint32_t>(0);
 
 			if (numberOfLoops)
-				GetTime(ncsfFilename, &sdat, sdat.infoSection.SEQrecord.entries[0].sseq, tags, !!options[VERBOSE], numberOfLoops, fadeLoop, fadeOneShot);
+				GetTime(ncsfFilename, &sdat, sdat.infoSection.SEQrecord.entries[0].sseq, tags, !!options[VERBOSE], numberOfLoops, fadeLoop, fadeOneShot, !!options[EXACTLOOPS]);
 
-			MakeNCSF(dirName + "/" + ncsfFilename, reservedData, fileData.data, tags.GetTags());
+			MakeNCSF(dirName + "/" + ncsfFilename, reservedData, fileData, tags.GetTags());
 			if (options[VERBOSE])
 				std::cout << "Created " << ncsfFilename << "\n";
 		}
@@ -114,7 +145,7 @@ int main(int argc, char *argv[])
 			std::string ncsflibFilename = GetFilenameFromPath(sdatFilename);
 			size_t libdot = ncsflibFilename.rfind('.');
 			ncsflibFilename = ncsflibFilename.substr(0, libdot) + ".ncsflib";
-			MakeNCSF(dirName + "/" + ncsflibFilename, std::vector<uint8_t>(), fileData.data);
+			MakeNCSF(dirName + "/" + ncsflibFilename, std::vector<uint8_t>(), fileData);
 			if (options[VERBOSE])
 				std::cout << "Created " << ncsflibFilename << "\n";
 
@@ -134,7 +165,7 @@ int main(int argc, char *argv[])
 				thisTags["origFilename"] = sdat.infoSection.SEQrecord.entries[i].sseq->origFilename;
 
 				if (numberOfLoops)
-					GetTime(minincsfFilename, &sdat, sdat.infoSection.SEQrecord.entries[i].sseq, thisTags, !!options[VERBOSE], numberOfLoops, fadeLoop, fadeOneShot);
+					GetTime(minincsfFilename, &sdat, sdat.infoSection.SEQrecord.entries[i].sseq, thisTags, !!options[VERBOSE], numberOfLoops, fadeLoop, fadeOneShot, !!options[EXACTLOOPS]);
 
 				MakeNCSF(dirName + "/" + minincsfFilename, reservedData, std::vector<uint8_t>(), thisTags.GetTags());
 				if (options[VERBOSE])
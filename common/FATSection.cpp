@@ -1,7 +1,7 @@
 /*
  * SDAT - FAT (File Allocation Table) Section structures
  * By Naram Qashat (CyberBotX) [cyberbotx@cyberbotx.com]
- * Last modification on 2013-03-25
+ * Last modification on 2026-10-17
  *
  * Nintendo DS Nitro Composer (SDAT) Specification document found at
  * http://www.feshrine.net/hacking/doc/nds-sdat.html
@@ -13,12 +13,11 @@ FATRecord::FATRecord() : offset(0), size(0)
 {
 }
 
-void FATRecord::Read(PseudoReadFile &file)
+void FATRecord::Read(PseudoReadCursor &cursor)
 {
-	this->offset = file.ReadLE<uint32_t>();
-	this->size = file.ReadLE<uint32_t>();
-	uint32_t reserved[2];
-	file.ReadLE(reserved);
+	this->offset = cursor.ReadLE<uint32_t>();
+	this->size = cursor.ReadLE<uint32_t>();
+	cursor.Skip(8); // reserved
 }
 
 void FATRecord::Write(PseudoWrite &file) const
@@ -34,16 +33,18 @@ FATSection::FATSection() : size(0), count(0), records()
 	memcpy(this->type, "FAT ", sizeof(this->type));
 }
 
-void FATSection::Read(PseudoReadFile &file)
+void FATSection::Read(PseudoReadView &file)
 {
-	file.ReadLE(this->type);
+	auto header = file.GetCursor(12);
+	header.ReadLE(this->type);
 	if (!VerifyHeader(this->type, "FAT "))
 		throw std::runtime_error("SDAT FAT Section invalid");
-	this->size = file.ReadLE<uint32_t>();
-	this->count = file.ReadLE<uint32_t>();
+	this->size = header.ReadLE<uint32_t>();
+	this->count = header.ReadLE<uint32_t>();
+	auto recordsCursor = file.GetCursor(16 * static_cast<size_t>(this->count));
 	this->records.resize(this->count);
 	for (uint32_t i = 0; i < this->count; ++i)
-		this->records[i].Read(file);
+		this->records[i].Read(recordsCursor);
 }
 
 uint32_t FATSection::Size() const
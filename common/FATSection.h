@@ -1,7 +1,7 @@
 /*
  * SDAT - FAT (File Allocation Table) Section structures
  * By Naram Qashat (CyberBotX) [cyberbotx@cyberbotx.com]
- * Last modification on 2014-10-15
+ * Last modification on 2026-10-17
  *
  * Nintendo DS Nitro Composer (SDAT) Specification document found at
  * http://www.feshrine.net/hacking/doc/nds-sdat.html
@@ -18,7 +18,7 @@ struct FATRecord
 
 	FATRecord();
 
-	void Read(PseudoReadFile &file);
+	void Read(PseudoReadCursor &cursor);
 	void Write(PseudoWrite &file) const;
 };
 
@@ -31,7 +31,7 @@ struct FATSection
 
 	FATSection();
 
-	void Read(PseudoReadFile &file);
+	void Read(PseudoReadView &file);
 	uint32_t Size() const;
 	void Write(PseudoWrite &file) const;
 };
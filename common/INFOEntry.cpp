@@ -1,7 +1,7 @@
 /*
  * SDAT - INFO Entry structures
  * By Naram Qashat (CyberBotX) [cyberbotx@cyberbotx.com]
- * Last modification on 2014-10-25
+ * Last modification on 2026-10-17
  *
  * Nintendo DS Nitro Composer (SDAT) Specification document found at
  * http://www.feshrine.net/hacking/doc/nds-sdat.html
@@ -9,11 +9,15 @@
 
 #include "INFOEntry.h"
 
-INFOEntry::INFOEntry() : fileData(), origFilename(""), sdatNumber("")
+INFOEntry::INFOEntry() : fileData(), fileNeedsRead(false), origFilename(""), sdatNumber("")
 {
 }
 
-INFOEntry::INFOEntry(const INFOEntry& entry) : fileData(entry.fileData), origFilename(entry.origFilename), sdatNumber(entry.sdatNumber)
+INFOEntry::INFOEntry(const INFOEntry& entry) : fileData(entry.fileData), fileNeedsRead(entry.fileNeedsRead), origFilename(entry.origFilename), sdatNumber(entry.sdatNumber)
+{
+}
+
+INFOEntry::INFOEntry(INFOEntry &&entry) : fileData(std::move(entry.fileData)), fileNeedsRead(entry.fileNeedsRead), origFilename(std::move(entry.origFilename)), sdatNumber(std::move(entry.sdatNumber))
 {
 }
 
@@ -22,12 +26,25 @@ INFOEntry &INFOEntry::operator=(const INFOEntry &entry)
 	if (this != &entry)
 	{
 		this->fileData = entry.fileData;
+		this->fileNeedsRead = entry.fileNeedsRead;
 		this->origFilename = entry.origFilename;
 		this->sdatNumber = entry.sdatNumber;
 	}
 	return *this;
 }
 
+INFOEntry &INFOEntry::operator=(INFOEntry &&entry)
+{
+	if (this != &entry)
+	{
+		this->fileData = std::move(entry.fileData);
+		this->fileNeedsRead = entry.fileNeedsRead;
+		this->origFilename = std::move(entry.origFilename);
+		this->sdatNumber = std::move(entry.sdatNumber);
+	}
+	return *this;
+}
+
 std::string INFOEntry::FullFilename(bool multipleSDATs) const
 {
 	std::string filename = this->origFilename;
@@ -47,6 +64,12 @@ INFOEntrySEQ::INFOEntrySEQ(const INFOEntrySEQ &entry) : INFOEntry(entry), fileID
 	memcpy(this->unknown2, entry.unknown2, sizeof(this->unknown2));
 }
 
+INFOEntrySEQ::INFOEntrySEQ(INFOEntrySEQ &&entry) : INFOEntry(std::move(entry)), fileID(entry.fileID), unknown(entry.unknown), bank(entry.bank), vol(entry.vol), cpr(entry.cpr),
+	ppr(entry.ppr), ply(entry.ply), sseq(entry.sseq)
+{
+	memcpy(this->unknown2, entry.unknown2, sizeof(this->unknown2));
+}
+
 INFOEntrySEQ &INFOEntrySEQ::operator=(const INFOEntrySEQ &entry)
 {
 	if (this != &entry)
@@ -65,16 +88,34 @@ INFOEntrySEQ &INFOEntrySEQ::operator=(const INFOEntrySEQ &entry)
 	return *this;
 }
 
-void INFOEntrySEQ::Read(PseudoReadFile &file)
+INFOEntrySEQ &INFOEntrySEQ::operator=(INFOEntrySEQ &&entry)
+{
+	if (this != &entry)
+	{
+		INFOEntry::operator=(std::move(entry));
+		this->fileID = entry.fileID;
+		this->unknown = entry.unknown;
+		this->bank = entry.bank;
+		this->vol = entry.vol;
+		this->cpr = entry.cpr;
+		this->ppr = entry.ppr;
+		this->ply = entry.ply;
+		memcpy(this->unknown2, entry.unknown2, sizeof(this->unknown2));
+		this->sseq = entry.sseq;
+	}
+	return *this;
+}
+
+void INFOEntrySEQ::Read(PseudoReadCursor &cursor)
 {
-	this->fileID = file.ReadLE<uint16_t>();
-	this->unknown = file.ReadLE<uint16_t>();
-	this->bank = file.ReadLE<uint16_t>();
-	this->vol = file.ReadLE<uint8_t>();
-	this->cpr = file.ReadLE<uint8_t>();
-	this->ppr = file.ReadLE<uint8_t>();
-	this->ply = file.ReadLE<uint8_t>();
-	file.ReadLE(this->unknown2);
+	this->fileID = cursor.ReadLE<uint16_t>();
+	this->unknown = cursor.ReadLE<uint16_t>();
+	this->bank = cursor.ReadLE<uint16_t>();
+	this->vol = cursor.ReadLE<uint8_t>();
+	this->cpr = cursor.ReadLE<uint8_t>();
+	this->ppr = cursor.ReadLE<uint8_t>();
+	this->ply = cursor.ReadLE<uint8_t>();
+	cursor.ReadLE(this->unknown2);
 }
 
 uint32_t INFOEntrySEQ::Size() const
@@ -104,6 +145,11 @@ INFOEntryBANK::INFOEntryBANK(const INFOEntryBANK &entry) : INFOEntry(entry), fil
 	memcpy(this->waveArc, entry.waveArc, sizeof(this->waveArc));
 }
 
+INFOEntryBANK::INFOEntryBANK(INFOEntryBANK &&entry) : INFOEntry(std::move(entry)), fileID(entry.fileID), unknown(entry.unknown), sbnk(entry.sbnk)
+{
+	memcpy(this->waveArc, entry.waveArc, sizeof(this->waveArc));
+}
+
 INFOEntryBANK &INFOEntryBANK::operator=(const INFOEntryBANK &entry)
 {
 	if (this != &entry)
@@ -117,11 +163,24 @@ INFOEntryBANK &INFOEntryBANK::operator=(const INFOEntryBANK &entry)
 	return *this;
 }
 
-void INFOEntryBANK::Read(PseudoReadFile &file)
+INFOEntryBANK &INFOEntryBANK::operator=(INFOEntryBANK &&entry)
+{
+	if (this != &entry)
+	{
+		INFOEntry::operator=(std::move(entry));
+		this->fileID = entry.fileID;
+		this->unknown = entry.unknown;
+		memcpy(this->waveArc, entry.waveArc, sizeof(this->waveArc));
+		this->sbnk = entry.sbnk;
+	}
+	return *this;
+}
+
+void INFOEntryBANK::Read(PseudoReadCursor &cursor)
 {
-	this->fileID = file.ReadLE<uint16_t>();
-	this->unknown = file.ReadLE<uint16_t>();
-	file.ReadLE(this->waveArc);
+	this->fileID = cursor.ReadLE<uint16_t>();
+	this->unknown = cursor.ReadLE<uint16_t>();
+	cursor.ReadLE(this->waveArc);
 }
 
 uint32_t INFOEntryBANK::Size() const
@@ -144,6 +203,10 @@ INFOEntryWAVEARC::INFOEntryWAVEARC(const INFOEntryWAVEARC &entry) : INFOEntry(en
 {
 }
 
+INFOEntryWAVEARC::INFOEntryWAVEARC(INFOEntryWAVEARC &&entry) : INFOEntry(std::move(entry)), fileID(entry.fileID), unknown(entry.unknown), swar(entry.swar)
+{
+}
+
 INFOEntryWAVEARC &INFOEntryWAVEARC::operator=(const INFOEntryWAVEARC &entry)
 {
 	if (this != &entry)
@@ -156,10 +219,22 @@ INFOEntryWAVEARC &INFOEntryWAVEARC::operator=(const INFOEntryWAVEARC &entry)
 	return *this;
 }
 
-void INFOEntryWAVEARC::Read(PseudoReadFile &file)
+INFOEntryWAVEARC &INFOEntryWAVEARC::operator=(INFOEntryWAVEARC &&entry)
+{
+	if (this != &entry)
+	{
+		INFOEntry::operator=(std::move(entry));
+		this->fileID = entry.fileID;
+		this->unknown = entry.unknown;
+		this->swar = entry.swar;
+	}
+	return *this;
+}
+
+void INFOEntryWAVEARC::Read(PseudoReadCursor &cursor)
 {
-	this->fileID = file.ReadLE<uint16_t>();
-	this->unknown = file.ReadLE<uint16_t>();
+	this->fileID = cursor.ReadLE<uint16_t>();
+	this->unknown = cursor.ReadLE<uint16_t>();
 }
 
 uint32_t INFOEntryWAVEARC::Size() const
@@ -181,6 +256,10 @@ INFOEntryPLAYER::INFOEntryPLAYER(const INFOEntryPLAYER &entry) : INFOEntry(entry
 {
 }
 
+INFOEntryPLAYER::INFOEntryPLAYER(INFOEntryPLAYER &&entry) : INFOEntry(std::move(entry)), maxSeqs(entry.maxSeqs), channelMask(entry.channelMask), heapSize(entry.heapSize)
+{
+}
+
 INFOEntryPLAYER &INFOEntryPLAYER::operator=(const INFOEntryPLAYER &entry)
 {
 	if (this != &entry)
@@ -193,11 +272,23 @@ INFOEntryPLAYER &INFOEntryPLAYER::operator=(const INFOEntryPLAYER &entry)
 	return *this;
 }
 
-void INFOEntryPLAYER::Read(PseudoReadFile &file)
+INFOEntryPLAYER &INFOEntryPLAYER::operator=(INFOEntryPLAYER &&entry)
+{
+	if (this != &entry)
+	{
+		INFOEntry::operator=(std::move(entry));
+		this->maxSeqs = entry.maxSeqs;
+		this->channelMask = entry.channelMask;
+		this->heapSize = entry.heapSize;
+	}
+	return *this;
+}
+
+void INFOEntryPLAYER::Read(PseudoReadCursor &cursor)
 {
-	this->maxSeqs = file.ReadLE<uint16_t>();
-	this->channelMask = file.ReadLE<uint16_t>();
-	this->heapSize = file.ReadLE<uint32_t>();
+	this->maxSeqs = cursor.ReadLE<uint16_t>();
+	this->channelMask = cursor.ReadLE<uint16_t>();
+	this->heapSize = cursor.ReadLE<uint32_t>();
 }
 
 uint32_t INFOEntryPLAYER::Size() const
@@ -1,7 +1,7 @@
 /*
  * SDAT - INFO Entry structures
  * By Naram Qashat (CyberBotX) [cyberbotx@cyberbotx.com]
- * Last modification on 2014-10-25
+ * Last modification on 2026-10-17
  *
  * Nintendo DS Nitro Composer (SDAT) Specification document found at
  * http://www.feshrine.net/hacking/doc/nds-sdat.html
@@ -17,19 +17,23 @@ struct SWAR;
 
 struct INFOEntry
 {
-	std::vector<uint8_t> fileData;
+	SharedBytes fileData;
+	// Set when the file was not parsed when the SDAT was read, see SDAT::Read
+	bool fileNeedsRead;
 	std::string origFilename;
 	std::string sdatNumber;
 
 	INFOEntry();
 	INFOEntry(const INFOEntry &entry);
+	INFOEntry(INFOEntry &&entry);
 	INFOEntry &operator=(const INFOEntry &entry);
+	INFOEntry &operator=(INFOEntry &&entry);
 
 	virtual ~INFOEntry()
 	{
 	}
 
-	virtual void Read(PseudoReadFile &file) = 0;
+	virtual void Read(PseudoReadCursor &cursor) = 0;
 	virtual uint32_t Size() const = 0;
 	virtual void Write(PseudoWrite &file) const = 0;
 
@@ -46,13 +50,15 @@ struct INFOEntrySEQ : INFOEntry
 	uint8_t ppr;
 	uint8_t ply;
 	uint8_t unknown2[2];
-	const SSEQ *sseq;
+	SSEQ *sseq;
 
 	INFOEntrySEQ();
 	INFOEntrySEQ(const INFOEntrySEQ &entry);
+	INFOEntrySEQ(INFOEntrySEQ &&entry);
 	INFOEntrySEQ &operator=(const INFOEntrySEQ &entry);
+	INFOEntrySEQ &operator=(INFOEntrySEQ &&entry);
 
-	void Read(PseudoReadFile &file);
+	void Read(PseudoReadCursor &cursor);
 	uint32_t Size() const;
 	void Write(PseudoWrite &file) const;
 };
@@ -62,13 +68,15 @@ struct INFOEntryBANK : INFOEntry
 	uint16_t fileID;
 	uint16_t unknown;
 	uint16_t waveArc[4];
-	const SBNK *sbnk;
+	SBNK *sbnk;
 
 	INFOEntryBANK();
 	INFOEntryBANK(const INFOEntryBANK &entry);
+	INFOEntryBANK(INFOEntryBANK &&entry);
 	INFOEntryBANK &operator=(const INFOEntryBANK &entry);
+	INFOEntryBANK &operator=(INFOEntryBANK &&entry);
 
-	void Read(PseudoReadFile &file);
+	void Read(PseudoReadCursor &cursor);
 	uint32_t Size() const;
 	void Write(PseudoWrite &file) const;
 };
@@ -77,13 +85,15 @@ struct INFOEntryWAVEARC : INFOEntry
 {
 	uint16_t fileID;
 	uint16_t unknown;
-	const SWAR *swar;
+	SWAR *swar;
 
 	INFOEntryWAVEARC();
 	INFOEntryWAVEARC(const INFOEntryWAVEARC &entry);
+	INFOEntryWAVEARC(INFOEntryWAVEARC &&entry);
 	INFOEntryWAVEARC &operator=(const INFOEntryWAVEARC &entry);
+	INFOEntryWAVEARC &operator=(INFOEntryWAVEARC &&entry);
 
-	void Read(PseudoReadFile &file);
+	void Read(PseudoReadCursor &cursor);
 	uint32_t Size() const;
 	void Write(PseudoWrite &file) const;
 };
@@ -96,9 +106,11 @@ struct INFOEntryPLAYER : INFOEntry
 
 	INFOEntryPLAYER();
 	INFOEntryPLAYER(const INFOEntryPLAYER &entry);
+	INFOEntryPLAYER(INFOEntryPLAYER &&entry);
 	INFOEntryPLAYER &operator=(const INFOEntryPLAYER &entry);
+	INFOEntryPLAYER &operator=(INFOEntryPLAYER &&entry);
 
-	void Read(PseudoReadFile &file);
+	void Read(PseudoReadCursor &cursor);
 	uint32_t Size() const;
 	void Write(PseudoWrite &file) const;
 };
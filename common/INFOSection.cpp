@@ -1,7 +1,7 @@
 /*
  * SDAT - INFO Section structures
  * By Naram Qashat (CyberBotX) [cyberbotx@cyberbotx.com]
- * Last modification on 2014-10-25
+ * Last modification on 2026-10-17
  *
  * Nintendo DS Nitro Composer (SDAT) Specification document found at
  * http://www.feshrine.net/hacking/doc/nds-sdat.html
@@ -13,17 +13,19 @@ template<typename T> INFORecord<T>::INFORecord() : count(0), actualCount(0), ent
 {
 }
 
-template<typename T> void INFORecord<T>::Read(PseudoReadFile &file, uint32_t startOffset)
+template<typename T> void INFORecord<T>::Read(PseudoReadView &file, uint32_t startOffset)
 {
 	this->count = file.ReadLE<uint32_t>();
+	auto offsets = file.GetCursor(4 * static_cast<size_t>(this->count));
 	this->entryOffsets.resize(this->count);
-	file.ReadLE(this->entryOffsets);
+	offsets.ReadLE(this->entryOffsets);
 	this->entries.resize(this->count);
 	for (uint32_t i = 0; i < this->count; ++i)
 		if (this->entryOffsets[i])
 		{
 			file.pos = startOffset + this->entryOffsets[i];
-			this->entries[i].Read(file);
+			auto entry = file.GetCursor(this->entries[i].Size());
+			this->entries[i].Read(entry);
 			++this->actualCount;
 		}
 }
@@ -36,7 +38,7 @@ template<typename T> uint32_t INFORecord<T>::Size() const
 	return recordSize;
 }
 
-template<typename T> void INFORecord<T>::FixOffsets(uint32_t startOffset)
+template<typename T> uint32_t INFORecord<T>::FixOffsets(uint32_t startOffset)
 {
 	uint32_t offset = startOffset;
 	for (uint32_t i = 0; i < this->count; ++i)
@@ -44,6 +46,7 @@ template<typename T> void INFORecord<T>::FixOffsets(uint32_t startOffset)
 		this->entryOffsets[i] = offset;
 		offset += this->entries[i].Size();
 	}
+	return offset;
 }
 
 template<typename T> void INFORecord<T>::WriteHeader(PseudoWrite &file) const
@@ -64,14 +67,15 @@ INFOSection::INFOSection() : size(0), SEQrecord(), BANKrecord(), WAVEARCrecord()
 	memset(this->recordOffsets, 0, sizeof(this->recordOffsets));
 }
 
-void INFOSection::Read(PseudoReadFile &file)
+void INFOSection::Read(PseudoReadView &file)
 {
 	uint32_t startOfINFO = file.pos;
-	file.ReadLE(this->type);
+	auto header = file.GetCursor(40);
+	header.ReadLE(this->type);
 	if (!VerifyHeader(this->type, "INFO"))
 		throw std::runtime_error("SDAT INFO Section invalid");
-	this->size = file.ReadLE<uint32_t>();
-	file.ReadLE(this->recordOffsets);
+	this->size = header.ReadLE<uint32_t>();
+	header.ReadLE(this->recordOffsets);
 	if (this->recordOffsets[REC_SEQ])
 	{
 		file.pos = startOfINFO + this->recordOffsets[REC_SEQ];
@@ -115,13 +119,11 @@ void INFOSection::FixOffsets()
 	this->recordOffsets[REC_PLAYER2] = this->recordOffsets[REC_GROUP] + 4;
 	this->recordOffsets[REC_STRM] = this->recordOffsets[REC_PLAYER2] + 4;
 	uint32_t offset = this->recordOffsets[REC_STRM] + 4;
-	this->SEQrecord.FixOffsets(offset);
-	offset += this->SEQrecord.Size() - 4 - 4 * this->SEQrecord.count;
-	this->BANKrecord.FixOffsets(offset);
-	offset += this->BANKrecord.Size() - 4 - 4 * this->BANKrecord.count;
-	this->WAVEARCrecord.FixOffsets(offset);
-	offset += this->WAVEARCrecord.Size() - 4 - 4 * this->WAVEARCrecord.count;
-	this->PLAYERrecord.FixOffsets(offset);
+	offset = this->SEQrecord.FixOffsets(offset);
+	offset = this->BANKrecord.FixOffsets(offset);
+	offset = this->WAVEARCrecord.FixOffsets(offset);
+	// The entries are the last thing in the section, so the end of them is also the size of the section
+	this->size = this->PLAYERrecord.FixOffsets(offset);
 }
 
 void INFOSection::Write(PseudoWrite &file) const
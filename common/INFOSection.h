@@ -1,7 +1,7 @@
 /*
  * SDAT - INFO Section structures
  * By Naram Qashat (CyberBotX) [cyberbotx@cyberbotx.com]
- * Last modification on 2014-10-25
+ * Last modification on 2026-10-17
  *
  * Nintendo DS Nitro Composer (SDAT) Specification document found at
  * http://www.feshrine.net/hacking/doc/nds-sdat.html
@@ -19,9 +19,9 @@ template<typename T> struct INFORecord
 
 	INFORecord();
 
-	void Read(PseudoReadFile &file, uint32_t startOffset);
+	void Read(PseudoReadView &file, uint32_t startOffset);
 	uint32_t Size() const;
-	void FixOffsets(uint32_t startOffset);
+	uint32_t FixOffsets(uint32_t startOffset);
 	void WriteHeader(PseudoWrite &file) const;
 	void WriteData(PseudoWrite &file) const;
 };
@@ -38,7 +38,7 @@ struct INFOSection
 
 	INFOSection();
 
-	void Read(PseudoReadFile &file);
+	void Read(PseudoReadView &file);
 	uint32_t Size() const;
 	void FixOffsets();
 	void Write(PseudoWrite &file) const;
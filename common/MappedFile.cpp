@@ -0,0 +1,98 @@
+/*
+ * SDAT - Memory-mapped file structure
+ * By Naram Qashat (CyberBotX) [cyberbotx@cyberbotx.com]
+ * Last modification on 2026-10-17
+ */
+
+#include "MappedFile.h"
+#ifdef _WIN32
+# include "windowsh_wrapper.h"
+#else
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <fcntl.h>
+# include <unistd.h>
+#endif
+
+#ifdef _WIN32
+MappedFile::MappedFile() : data(nullptr), size(0), fileHandle(INVALID_HANDLE_VALUE), mappingHandle(nullptr)
+#else
+MappedFile::MappedFile() : data(nullptr), size(0)
+#endif
+{
+}
+
+MappedFile::~MappedFile()
+{
+	this->Close();
+}
+
+bool MappedFile::Open(const std::string &filename)
+{
+	this->Close();
+
+#ifdef _WIN32
+	this->fileHandle = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (this->fileHandle == INVALID_HANDLE_VALUE)
+		return false;
+	LARGE_INTEGER fileSize;
+	// Empty files can't be mapped, so those are left to the fallback as well
+	if (!GetFileSizeEx(this->fileHandle, &fileSize) || !fileSize.QuadPart || static_cast<uint64_t>(fileSize.QuadPart) > SIZE_MAX)
+	{
+		this->Close();
+		return false;
+	}
+	this->mappingHandle = CreateFileMapping(this->fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!this->mappingHandle)
+	{
+		this->Close();
+		return false;
+	}
+	this->data = static_cast<const uint8_t *>(MapViewOfFile(this->mappingHandle, FILE_MAP_READ, 0, 0, 0));
+	if (!this->data)
+	{
+		this->Close();
+		return false;
+	}
+	this->size = static_cast<size_t>(fileSize.QuadPart);
+#else
+	int fd = open(filename.c_str(), O_RDONLY);
+	if (fd == -1)
+		return false;
+	struct stat st;
+	// Empty files can't be mapped, so those are left to the fallback as well
+	if (fstat(fd, &st) || !S_ISREG(st.st_mode) || !st.st_size || static_cast<uint64_t>(st.st_size) > SIZE_MAX)
+	{
+		close(fd);
+		return false;
+	}
+	void *mapping = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+	// The mapping stays valid after the descriptor is closed
+	close(fd);
+	if (mapping == MAP_FAILED)
+		return false;
+	this->data = static_cast<const uint8_t *>(mapping);
+	this->size = static_cast<size_t>(st.st_size);
+#endif
+
+	return true;
+}
+
+void MappedFile::Close()
+{
+#ifdef _WIN32
+	if (this->data)
+		UnmapViewOfFile(this->data);
+	if (this->mappingHandle)
+		CloseHandle(this->mappingHandle);
+	if (this->fileHandle != INVALID_HANDLE_VALUE)
+		CloseHandle(this->fileHandle);
+	this->mappingHandle = nullptr;
+	this->fileHandle = INVALID_HANDLE_VALUE;
+#else
+	if (this->data)
+		munmap(const_cast<uint8_t *>(this->data), this->size);
+#endif
+	this->data = nullptr;
+	this->size = 0;
+}
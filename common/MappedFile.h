@@ -0,0 +1,39 @@
+/*
+ * SDAT - Memory-mapped file structure
+ * By Naram Qashat (CyberBotX) [cyberbotx@cyberbotx.com]
+ * Last modification on 2026-10-17
+ */
+
+#pragma once
+
+#include <string>
+#include <cstdint>
+
+/*
+ * A read-only view of an entire file, mapped into memory by the OS.
+ *
+ * This allows large files (such as DSi ROMs) to be scanned without first
+ * copying the entire file into memory, pages are only brought in as they
+ * are accessed.  Open will return false if the file could not be mapped,
+ * in which case the caller is expected to fall back to reading the file.
+ */
+class MappedFile
+{
+	const uint8_t *data;
+	size_t size;
+#ifdef _WIN32
+	void *fileHandle, *mappingHandle;
+#endif
+
+	MappedFile(const MappedFile &);
+	MappedFile &operator=(const MappedFile &);
+public:
+	MappedFile();
+	~MappedFile();
+
+	bool Open(const std::string &filename);
+	void Close();
+
+	const uint8_t *Data() const { return this->data; }
+	size_t Size() const { return this->size; }
+};
@@ -1,33 +1,72 @@
 /*
  * Common NCSF functions
  * By Naram Qashat (CyberBotX) [cyberbotx@cyberbotx.com]
- * Last modification on 2014-12-08
+ * Last modification on 2026-10-17
  */
 
 #include <fstream>
 #include <memory>
+#include <functional>
 #include <iostream>
 #include <cmath>
 #include <zlib.h>
 #include "NCSF.h"
 #include "TimerPlayer.h"
 
-// Create an NCSF file
-void MakeNCSF(const std::string &filename, const std::vector<uint8_t> &reservedSectionData, const std::vector<uint8_t> &programSectionData,
-	const std::vector<std::string> &tags)
+// Streams the program section through zlib as it is written, so neither the
+// uncompressed nor the compressed program section has to be held in memory.
+// The compressed data goes directly to the file, with a running CRC being kept
+// of it.  The settings are the same as compress2 uses at level 9, so the result
+// is identical to compressing the entire program section at once.
+struct DeflateStream
 {
-	// Create zlib compressed version of program section, if one was given
-	auto finalProgramSectionData = programSectionData;
+	z_stream stream;
+	std::ofstream *file;
+	std::vector<uint8_t> outBuffer;
+	uint32_t compressedSize, crc;
 
-	unsigned long programCompressedSize = finalProgramSectionData.empty() ? 0 : compressBound(finalProgramSectionData.size());
-	auto programCompressedData = std::vector<uint8_t>(programCompressedSize);
+	DeflateStream(std::ofstream *ofile) : stream(), file(ofile), outBuffer(PseudoWriteFile::BufferSize), compressedSize(0), crc(crc32(0, Z_NULL, 0))
+	{
+		if (deflateInit(&this->stream, 9) != Z_OK)
+			throw std::runtime_error("Unable to initialize zlib.");
+	}
 
-	if (programCompressedSize)
+	~DeflateStream()
 	{
-		compress2(&programCompressedData[0], &programCompressedSize, &finalProgramSectionData[0], finalProgramSectionData.size(), 9);
-		programCompressedData.resize(programCompressedSize);
+		deflateEnd(&this->stream);
 	}
 
+	void Deflate(const uint8_t *data, size_t size, int flush = Z_NO_FLUSH)
+	{
+		this->stream.next_in = const_cast<Bytef *>(data);
+		this->stream.avail_in = size;
+		do
+		{
+			this->stream.next_out = &this->outBuffer[0];
+			this->stream.avail_out = this->outBuffer.size();
+			if (deflate(&this->stream, flush) == Z_STREAM_ERROR)
+				throw std::runtime_error("Unable to compress program section.");
+			uint32_t compressedBytes = this->outBuffer.size() - this->stream.avail_out;
+			if (compressedBytes)
+			{
+				this->crc = crc32(this->crc, &this->outBuffer[0], compressedBytes);
+				this->file->write(reinterpret_cast<const char *>(&this->outBuffer[0]), compressedBytes);
+				this->compressedSize += compressedBytes;
+			}
+		} while (!this->stream.avail_out);
+	}
+
+	void Finish()
+	{
+		this->Deflate(nullptr, 0, Z_FINISH);
+	}
+};
+
+// Create an NCSF file, the program section (if there is one) is written by the
+// given function into the compressed stream
+static void MakeNCSF(const std::string &filename, const std::vector<uint8_t> &reservedSectionData, const std::function<void (DeflateStream &)> &writeProgramSection,
+	const std::vector<std::string> &tags)
+{
 	// Create file
 	std::ofstream file;
 	file.exceptions(std::ofstream::failbit | std::ofstream::badbit);
@@ -35,22 +74,25 @@ void MakeNCSF(const std::string &filename, const std::vector<uint8_t> &reservedS
 
 	PseudoWrite ofile(&file);
 
+	// The size and CRC of the compressed program section are not known until
+	// it has been written, so they are filled in afterwards
 	ofile.WriteLE("PSF", 3);
 	ofile.WriteLE<uint8_t>(0x25);
 	ofile.WriteLE<uint32_t>(reservedSectionData.empty() ? 0 : reservedSectionData.size());
-	ofile.WriteLE<uint32_t>(programCompressedSize);
-	if (programCompressedSize)
-	{
-		uint32_t crc = crc32(0, Z_NULL, 0);
-		crc = crc32(crc, &programCompressedData[0], programCompressedSize);
-		ofile.WriteLE(crc);
-	}
-	else
-		ofile.WriteLE<uint32_t>(0);
+	ofile.WriteLE<uint32_t>(0);
+	ofile.WriteLE<uint32_t>(0);
 	if (!reservedSectionData.empty())
 		ofile.WriteLE(reservedSectionData);
-	if (!programCompressedData.empty())
-		ofile.WriteLE(programCompressedData);
+	uint32_t programCompressedSize = 0, crc = 0;
+	if (writeProgramSection)
+	{
+		ofile.Flush();
+		DeflateStream programSection(&file);
+		writeProgramSection(programSection);
+		programSection.Finish();
+		programCompressedSize = programSection.compressedSize;
+		crc = programSection.crc;
+	}
 	if (!tags.empty())
 	{
 		ofile.WriteLE("[TAG]", 5);
@@ -60,16 +102,52 @@ void MakeNCSF(const std::string &filename, const std::vector<uint8_t> &reservedS
 			ofile.WriteLE<uint8_t>(0x0A);
 		}
 	}
+	ofile.Flush();
+
+	if (programCompressedSize)
+	{
+		file.seekp(8);
+		PseudoWrite header(&file);
+		header.WriteLE(programCompressedSize);
+		header.WriteLE(crc);
+		header.Flush();
+	}
 
 	file.close();
 }
 
+void MakeNCSF(const std::string &filename, const std::vector<uint8_t> &reservedSectionData, const std::vector<uint8_t> &programSectionData,
+	const std::vector<std::string> &tags)
+{
+	MakeNCSF(filename, reservedSectionData, PseudoReadView(programSectionData), tags);
+}
+
+void MakeNCSF(const std::string &filename, const std::vector<uint8_t> &reservedSectionData, const PseudoReadView &programSectionData,
+	const std::vector<std::string> &tags)
+{
+	std::function<void (DeflateStream &)> writeProgramSection;
+	if (programSectionData.size)
+		writeProgramSection = [&](DeflateStream &programSection) { programSection.Deflate(programSectionData.data, programSectionData.size); };
+	MakeNCSF(filename, reservedSectionData, writeProgramSection, tags);
+}
+
+// The SDAT is compressed as it is written, instead of being written to memory first
+void MakeNCSF(const std::string &filename, const std::vector<uint8_t> &reservedSectionData, const SDAT &sdat, const std::vector<std::string> &tags)
+{
+	MakeNCSF(filename, reservedSectionData, [&](DeflateStream &programSection)
+	{
+		PseudoWrite sdatData([&](const uint8_t *data, size_t size) { programSection.Deflate(data, size); });
+		sdat.Write(sdatData);
+		sdatData.Flush();
+	}, tags);
+}
+
 // Check if the given file data is a valid PSF, throwing an exception if it's
 // not a valid PSF
 void CheckForValidPSF(PseudoReadFile &file, uint8_t versionByte)
 {
 	// Various checks on the file's size will be done throughout
-	if (file.data.size() < 4)
+	if (file.size < 4)
 		throw std::range_error("File is too small.");
 
 	file.pos = 0;
@@ -86,7 +164,7 @@ void CheckForValidPSF(PseudoReadFile &file, uint8_t versionByte)
 		throw std::runtime_error("Version byte of " + NumToHexString<uint8_t>(PSFHeader[3]) +
 			" does not equal what we were looking for (" + NumToHexString(versionByte) + ").");
 
-	if (file.data.size() < 16)
+	if (file.size < 16)
 		throw std::range_error("File is too small.");
 
 	// Get the sizes on the reserved and program sections
@@ -96,13 +174,13 @@ void CheckForValidPSF(PseudoReadFile &file, uint8_t versionByte)
 	file.pos += 4;
 
 	// Check the reserved section
-	if (reservedSize && file.data.size() < reservedSize + 16)
+	if (reservedSize && file.size < reservedSize + 16)
 		throw std::range_error("File is too small.");
 
 	file.pos += reservedSize;
 
 	// Check the program section
-	if (programCompressedSize && file.data.size() < reservedSize + programCompressedSize + 16)
+	if (programCompressedSize && file.size < reservedSize + programCompressedSize + 16)
 		throw std::range_error("File is too small.");
 }
 
@@ -194,7 +272,7 @@ TagList GetTagsFromPSF(PseudoReadFile &file, uint8_t versionByte)
 		file.pos = TagOffset + 5;
 		std::string name, value;
 		bool onName = true;
-		size_t lengthOfTags = file.data.size() - file.pos;
+		size_t lengthOfTags = file.size - file.pos;
 		for (size_t x = 0; x < lengthOfTags; ++x)
 		{
 			char curr = file.ReadLE<uint8_t>();
@@ -280,46 +358,16 @@ void RemoveFiles(const Files &files)
 	std::for_each(files.begin(), files.end(), [](const std::string &file) { remove(file.c_str()); });
 }
 
-// Get time on SSEQ (uses a separate thread so it can be killed off if it takes longer than a few seconds)
-static Time GetTime(TimerPlayer *player, uint32_t loopCount, uint32_t numberOfLoops)
+// Get time on SSEQ (uses a separate thread so it can be killed off if it takes longer than the given number of milliseconds)
+static Time GetTime(TimerPlayer *player, uint32_t timeLimit, uint32_t numberOfLoops)
 {
 	player->loops = numberOfLoops;
 	player->StartLengthThread();
-	uint32_t i = 0;
-	for (; i < loopCount; ++i)
-	{
-		player->LockMutex();
-		bool doingLength = player->doLength;
-		player->UnlockMutex();
-		if (doingLength)
-		{
-#ifdef _WIN32
-			Sleep(150);
-#else
-			timespec req;
-			req.tv_sec = 0;
-			req.tv_nsec = 150000000;
-			while (nanosleep(&req, &req) == -1 && errno == EINTR);
-#endif
-		}
-		else
-			break;
-	}
-	Time length;
-	if (i == loopCount)
-	{
-		player->LockMutex();
+	// A player stopped early is left with the length it had found by then, if any
+	if (!player->WaitForLength(timeLimit))
 		player->doLength = false;
-		player->UnlockMutex();
-		player->WaitForThread();
-		length = Time(-1, LOOP);
-	}
-	else
-	{
-		player->WaitForThread();
-		length = player->length;
-	}
-	return length;
+	player->WaitForThread();
+	return player->length;
 }
 
 static inline int Cnv_Scale(int scale)
@@ -353,30 +401,40 @@ static inline int Cnv_Scale(int scale)
 // music), if the song is one-shot (and not looping), it will run the player
 // a second time, "playing" the song to determine when silence has occurred.
 // After which, it will store the data in the tags for the SSEQ.
-void GetTime(const std::string &filename, const SDAT *sdat, const SSEQ *sseq, TagList &tags, bool verbose, uint32_t numberOfLoops, uint32_t fadeLoop, uint32_t fadeOneShot)
+void GetTime(const std::string &filename, const SDAT *sdat, const SSEQ *sseq, TagList &tags, bool verbose, uint32_t numberOfLoops, uint32_t fadeLoop, uint32_t fadeOneShot, bool exactLoops)
 {
 	const auto &info = sdat->infoSection.SEQrecord.entries[sseq->entryNumber];
+	// Both passes run the same decoded SSEQ
+	auto program = std::make_shared<const TimerProgram>(sseq->data);
 	auto player = std::unique_ptr<TimerPlayer>(new TimerPlayer());
-	player->Setup(sseq, info.origFilename);
+	player->Setup(sseq, program);
 	player->maxSeconds = 6000;
+	player->exactLoops = exactLoops;
 	// Get the time, without "playing" the notes
-	Time length = GetTime(player.get(), 20, numberOfLoops);
+	Time length = GetTime(player.get(), 3000, numberOfLoops);
 	// If the length was for a one-shot song, get the time again, this time "playing" the notes
 	bool gotLength = false;
 	if (static_cast<int>(length.time) != -1 && length.type == END)
 	{
 		player.reset(new TimerPlayer());
 		player->sseqVol = Cnv_Scale(info.vol);
-		player->Setup(sseq, info.origFilename);
+		player->Setup(sseq, program);
 		const auto &sbnkInfo = sdat->infoSection.BANKrecord.entries[info.bank];
+		if (sbnkInfo.fileNeedsRead)
+			throw std::runtime_error("SBNK for " + filename + " was not read");
 		player->sbnk = sbnkInfo.sbnk;
 		for (int i = 0; i < 4; ++i)
 			if (sbnkInfo.waveArc[i] != 0xFFFF)
-				player->swar[i] = sdat->infoSection.WAVEARCrecord.entries[sbnkInfo.waveArc[i]].swar;
+			{
+				const auto &swarInfo = sdat->infoSection.WAVEARCrecord.entries[sbnkInfo.waveArc[i]];
+				if (swarInfo.fileNeedsRead)
+					throw std::runtime_error("SWAR for " + filename + " was not read");
+				player->swar[i] = swarInfo.swar;
+			}
 		player->maxSeconds = length.time + 30;
 		player->doNotes = true;
 		Time oldLength = length;
-		length = GetTime(player.get(), 40, numberOfLoops);
+		length = GetTime(player.get(), 6000, numberOfLoops);
 		if (static_cast<int>(length.time) != -1)
 			gotLength = true;
 		else
@@ -395,6 +453,8 @@ void GetTime(const std::string &filename, const SDAT *sdat, const SSEQ *sseq, Ta
 		if (verbose)
 		{
 			std::cout << "Time for " << filename << ": " << lengthString << " (" << (length.type == LOOP ? "timed to 2 loops" : "one-shot") << ")\n";
+			if (length.type == LOOP && player->loopLength > 0)
+				std::cout << "(Loops exactly every " << SecondsToString(player->loopLength) << " after an intro of " << SecondsToString(player->introLength) << ".)\n";
 			if (length.type == END && !gotLength)
 				std::cout << "(NOTE: Was unable to detect silence at the end of the track, time may be inaccurate.)\n";
 		}
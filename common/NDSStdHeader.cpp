@@ -1,7 +1,7 @@
 /*
  * SDAT - Nintendo DS Standard Header structure
  * By Naram Qashat (CyberBotX) [cyberbotx@cyberbotx.com]
- * Last modification on 2013-03-25
+ * Last modification on 2026-10-17
  *
  * Nintendo DS Nitro Composer (SDAT) Specification document found at
  * http://www.feshrine.net/hacking/doc/nds-sdat.html
@@ -14,7 +14,7 @@ NDSStdHeader::NDSStdHeader() : magic(0), fileSize(0), size(0), blocks(0)
 	memset(this->type, 0, sizeof(this->type));
 }
 
-void NDSStdHeader::Read(PseudoReadFile &file)
+void NDSStdHeader::Read(PseudoReadView &file)
 {
 	file.ReadLE(this->type);
 	this->magic = file.ReadLE<uint32_t>();
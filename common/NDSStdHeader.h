@@ -1,7 +1,7 @@
 /*
  * SDAT - Nintendo DS Standard Header structure
  * By Naram Qashat (CyberBotX) [cyberbotx@cyberbotx.com]
- * Last modification on 2014-10-15
+ * Last modification on 2026-10-17
  *
  * Nintendo DS Nitro Composer (SDAT) Specification document found at
  * http://www.feshrine.net/hacking/doc/nds-sdat.html
@@ -21,7 +21,7 @@ struct NDSStdHeader
 
 	NDSStdHeader();
 
-	void Read(PseudoReadFile &file);
+	void Read(PseudoReadView &file);
 	void Verify(const std::string &typeToCheck, uint32_t magicToCheck) const;
 	void Write(PseudoWrite &file) const;
 };
@@ -0,0 +1,124 @@
+/*
+ * SDAT - Parallel work functions
+ * By Naram Qashat (CyberBotX) [cyberbotx@cyberbotx.com]
+ * Last modification on 2026-10-17
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <vector>
+#include "Parallel.h"
+#ifdef _WIN32
+# include "windowsh_wrapper.h"
+#else
+# include <pthread.h>
+# include <unistd.h>
+#endif
+
+size_t GetProcessorCount()
+{
+#ifdef _WIN32
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return info.dwNumberOfProcessors;
+#else
+	long processors = sysconf(_SC_NPROCESSORS_ONLN);
+	return processors > 0 ? processors : 1;
+#endif
+}
+
+struct ParallelWork
+{
+	size_t count;
+	const std::function<void (size_t)> &work;
+	std::atomic<size_t> next;
+	std::vector<std::exception_ptr> errors;
+
+	ParallelWork(size_t workCount, const std::function<void (size_t)> &workFunction) : count(workCount), work(workFunction), next(0),
+		errors(workCount)
+	{
+	}
+
+	// Each thread takes the next index that has not been taken yet, so threads
+	// that get quick work will take on more of it
+	void Run()
+	{
+		size_t i;
+		while ((i = this->next++) < this->count)
+		{
+			try
+			{
+				this->work(i);
+			}
+			catch (...)
+			{
+				this->errors[i] = std::current_exception();
+			}
+		}
+	}
+private:
+	ParallelWork(const ParallelWork &);
+	ParallelWork &operator=(const ParallelWork &);
+};
+
+#ifdef _WIN32
+static DWORD WINAPI ParallelWorkThread(void *handle)
+#else
+static void *ParallelWorkThread(void *handle)
+#endif
+{
+	reinterpret_cast<ParallelWork *>(handle)->Run();
+#ifdef _WIN32
+	return 0;
+#else
+	return nullptr;
+#endif
+}
+
+void ParallelFor(size_t count, size_t maxThreads, const std::function<void (size_t)> &work)
+{
+	// With only 1 thread, the work is done in order and the first exception stops it, the same as a plain loop would
+	size_t numberOfThreads = std::max<size_t>(1, std::min(maxThreads, count));
+	if (numberOfThreads == 1)
+	{
+		for (size_t i = 0; i < count; ++i)
+			work(i);
+		return;
+	}
+
+	ParallelWork parallelWork(count, work);
+
+	// The calling thread is the first of the threads
+#ifdef _WIN32
+	auto threads = std::vector<HANDLE>(numberOfThreads, nullptr);
+	for (size_t i = 1; i < numberOfThreads; ++i)
+	{
+		DWORD threadID;
+		threads[i] = CreateThread(nullptr, 0, ParallelWorkThread, &parallelWork, 0, &threadID);
+	}
+#else
+	auto threads = std::vector<pthread_t>(numberOfThreads);
+	auto threadCreated = std::vector<bool>(numberOfThreads, false);
+	for (size_t i = 1; i < numberOfThreads; ++i)
+		threadCreated[i] = !pthread_create(&threads[i], nullptr, ParallelWorkThread, &parallelWork);
+#endif
+	parallelWork.Run();
+	for (size_t i = 1; i < numberOfThreads; ++i)
+	{
+#ifdef _WIN32
+		if (threads[i])
+		{
+			WaitForSingleObject(threads[i], INFINITE);
+			CloseHandle(threads[i]);
+		}
+#else
+		if (threadCreated[i])
+			pthread_join(threads[i], nullptr);
+#endif
+	}
+
+	auto error = std::find_if(parallelWork.errors.begin(), parallelWork.errors.end(), [](const std::exception_ptr &thisError) { return !!thisError; });
+	if (error != parallelWork.errors.end())
+		std::rethrow_exception(*error);
+}
@@ -0,0 +1,24 @@
+/*
+ * SDAT - Parallel work functions
+ * By Naram Qashat (CyberBotX) [cyberbotx@cyberbotx.com]
+ * Last modification on 2026-10-17
+ */
+
+#pragma once
+
+#include <functional>
+#include <cstddef>
+
+size_t GetProcessorCount();
+
+/*
+ * Calls work for every index from 0 to count - 1, spread across up to
+ * maxThreads threads (including the calling thread), returning once all of
+ * the work is done.  The indexes are handed out in order, but the order they
+ * finish in is not guaranteed, so work should only write to its own results.
+ *
+ * If any of the calls threw an exception, the one from the lowest index is
+ * rethrown once all the threads have finished.  If a thread could not be
+ * created, the calling thread does its share of the work instead.
+ */
+void ParallelFor(size_t count, size_t maxThreads, const std::function<void (size_t)> &work);
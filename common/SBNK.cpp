@@ -1,7 +1,7 @@
 /*
  * SSEQ Player - SDAT SBNK (Sound Bank) structures
  * By Naram Qashat (CyberBotX)
- * Last modification on 2014-12-08
+ * Last modification on 2026-10-17
  *
  * Nintendo DS Nitro Composer (SDAT) Specification document found at
  * http://www.feshrine.net/hacking/doc/nds-sdat.html
@@ -15,16 +15,16 @@ SBNKInstrumentRange::SBNKInstrumentRange(uint8_t lowerNote, uint8_t upperNote, i
 {
 }
 
-void SBNKInstrumentRange::Read(PseudoReadFile &file)
+void SBNKInstrumentRange::Read(PseudoReadCursor &cursor)
 {
-	this->swav = file.ReadLE<uint16_t>();
-	this->swar = file.ReadLE<uint16_t>();
-	this->noteNumber = file.ReadLE<uint8_t>();
-	this->attackRate = file.ReadLE<uint8_t>();
-	this->decayRate = file.ReadLE<uint8_t>();
-	this->sustainLevel = file.ReadLE<uint8_t>();
-	this->releaseRate = file.ReadLE<uint8_t>();
-	this->pan = file.ReadLE<uint8_t>();
+	this->swav = cursor.ReadLE<uint16_t>();
+	this->swar = cursor.ReadLE<uint16_t>();
+	this->noteNumber = cursor.ReadLE<uint8_t>();
+	this->attackRate = cursor.ReadLE<uint8_t>();
+	this->decayRate = cursor.ReadLE<uint8_t>();
+	this->sustainLevel = cursor.ReadLE<uint8_t>();
+	this->releaseRate = cursor.ReadLE<uint8_t>();
+	this->pan = cursor.ReadLE<uint8_t>();
 }
 
 void SBNKInstrumentRange::Write(PseudoWrite &file) const
@@ -43,52 +43,59 @@ SBNKInstrument::SBNKInstrument() : record(0), ranges()
 {
 }
 
-void SBNKInstrument::Read(PseudoReadFile &file, uint32_t startOffset)
+// The header cursor covers the instrument's 4 byte entry in the SBNK's
+// instrument list, the instrument's data is located through the file
+void SBNKInstrument::Read(PseudoReadCursor &header, PseudoReadView &file, uint32_t startOffset)
 {
-	this->record = file.ReadLE<uint8_t>();
-	this->offset = file.ReadLE<uint16_t>();
-	this->unknown = file.ReadLE<uint8_t>();
-	uint32_t endOfInst = file.pos;
-	file.pos = startOffset + this->offset;
+	this->record = header.ReadLE<uint8_t>();
+	this->offset = header.ReadLE<uint16_t>();
+	this->unknown = header.ReadLE<uint8_t>();
 	if (this->record)
 	{
+		file.pos = startOffset + this->offset;
 		if (this->record == 16)
 		{
-			uint8_t lowNote = file.ReadLE<uint8_t>();
-			uint8_t highNote = file.ReadLE<uint8_t>();
+			auto notes = file.GetCursor(2);
+			uint8_t lowNote = notes.ReadLE<uint8_t>();
+			uint8_t highNote = notes.ReadLE<uint8_t>();
 			uint8_t num = highNote - lowNote + 1;
+			auto data = file.GetCursor(12 * num); // 2 for record type, 10 for instrument range
+			this->ranges.reserve(num);
 			for (uint8_t i = 0; i < num; ++i)
 			{
-				uint16_t thisRecord = file.ReadLE<uint16_t>();
+				uint16_t thisRecord = data.ReadLE<uint16_t>();
 				auto range = SBNKInstrumentRange(lowNote + i, lowNote + i, thisRecord);
-				range.Read(file);
+				range.Read(data);
 				this->ranges.push_back(range);
 			}
 		}
 		else if (this->record == 17)
 		{
 			uint8_t thisRanges[8];
-			file.ReadLE(thisRanges);
-			uint8_t i = 0;
-			while (i < 8 && thisRanges[i])
+			file.GetCursor(8).ReadLE(thisRanges);
+			uint8_t num = 0;
+			while (num < 8 && thisRanges[num])
+				++num;
+			auto data = file.GetCursor(12 * num); // 2 for record type, 10 for instrument range
+			this->ranges.reserve(num);
+			for (uint8_t i = 0; i < num; ++i)
 			{
-				uint16_t thisRecord = file.ReadLE<uint16_t>();
+				uint16_t thisRecord = data.ReadLE<uint16_t>();
 				uint8_t lowNote = i ? thisRanges[i - 1] + 1 : 0;
 				uint8_t highNote = thisRanges[i];
 				auto range = SBNKInstrumentRange(lowNote, highNote, thisRecord);
-				range.Read(file);
+				range.Read(data);
 				this->ranges.push_back(range);
-				++i;
 			}
 		}
 		else
 		{
+			auto data = file.GetCursor(10);
 			auto range = SBNKInstrumentRange(0, 127, this->record);
-			range.Read(file);
+			range.Read(data);
 			this->ranges.push_back(range);
 		}
 	}
-	file.pos = endOfInst;
 }
 
 uint32_t SBNKInstrument::Size() const
@@ -162,8 +169,9 @@ SBNK::SBNK(const std::string &fn) : filename(fn), header(), count(0), instrument
 {
 }
 
-void SBNK::Read(PseudoReadFile &file)
+void SBNK::Read(const SharedBytes &sbnkData, bool failOnMissingFiles)
 {
+	PseudoReadView file(sbnkData);
 	uint32_t startOfSBNK = file.pos;
 	this->header.Read(file);
 	try
@@ -172,22 +180,22 @@ void SBNK::Read(PseudoReadFile &file)
 	}
 	catch (const std::exception &)
 	{
-		if (SDAT::failOnMissingFiles)
+		if (failOnMissingFiles)
 			throw;
 		else
 			return;
 	}
+	auto dataHeader = file.GetCursor(44);
 	int8_t type[4];
-	file.ReadLE(type);
+	dataHeader.ReadLE(type);
 	if (!VerifyHeader(type, "DATA"))
 		throw std::runtime_error("SBNK DATA structure invalid");
-	file.ReadLE<uint32_t>(); // size
-	uint32_t reserved[8];
-	file.ReadLE(reserved);
-	this->count = file.ReadLE<uint32_t>();
+	dataHeader.Skip(36); // size + reserved
+	this->count = dataHeader.ReadLE<uint32_t>();
+	auto instrumentHeaders = file.GetCursor(4 * static_cast<size_t>(this->count));
 	this->instruments.resize(this->count);
 	for (uint32_t i = 0; i < this->count; ++i)
-		this->instruments[i].Read(file, startOfSBNK);
+		this->instruments[i].Read(instrumentHeaders, file, startOfSBNK);
 }
 
 uint32_t SBNK::Size() const
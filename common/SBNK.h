@@ -1,7 +1,7 @@
 /*
  * SDAT - SBNK (Sound Bank) structures
  * By Naram Qashat (CyberBotX)
- * Last modification on 2014-12-08
+ * Last modification on 2026-10-17
  *
  * Nintendo DS Nitro Composer (SDAT) Specification document found at
  * http://www.feshrine.net/hacking/doc/nds-sdat.html
@@ -29,7 +29,7 @@ struct SBNKInstrumentRange
 
 	SBNKInstrumentRange(uint8_t lowerNote, uint8_t upperNote, int recordType);
 
-	void Read(PseudoReadFile &file);
+	void Read(PseudoReadCursor &cursor);
 	void Write(PseudoWrite &file) const;
 };
 
@@ -42,7 +42,7 @@ struct SBNKInstrument
 
 	SBNKInstrument();
 
-	void Read(PseudoReadFile &file, uint32_t startOffset);
+	void Read(PseudoReadCursor &header, PseudoReadView &file, uint32_t startOffset);
 	uint32_t Size() const;
 	uint16_t FixOffset(uint16_t newOffset);
 	void WriteHeader(PseudoWrite &file) const;
@@ -60,7 +60,7 @@ struct SBNK
 
 	SBNK(const std::string &fn = "");
 
-	void Read(PseudoReadFile &file);
+	void Read(const SharedBytes &sbnkData, bool failOnMissingFiles);
 	uint32_t Size() const;
 	uint32_t DataSize() const;
 	void FixOffsets();
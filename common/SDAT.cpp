@@ -1,7 +1,7 @@
 /*
  * SDAT - SDAT structure
  * By Naram Qashat (CyberBotX) [cyberbotx@cyberbotx.com]
- * Last modification on 2014-12-08
+ * Last modification on 2026-10-17
  *
  * Nintendo DS Nitro Composer (SDAT) Specification document found at
  * http://www.feshrine.net/hacking/doc/nds-sdat.html
@@ -9,11 +9,14 @@
 
 #include <functional>
 #include <iostream>
+#include <iterator>
+#include <limits>
+#include <unordered_map>
+#include <unordered_set>
 #include "SDAT.h"
+#include "Parallel.h"
 #include "TimerTrack.h"
 
-bool SDAT::failOnMissingFiles = true;
-
 SDAT::SDAT() : filename(""), header(), SYMBOffset(0), SYMBSize(0), INFOOffset(0), INFOSize(0), FATOffset(0), FATSize(0), FILEOffset(0), FILESize(0), symbSection(),
 	infoSection(), fatSection(), symbSectionNeedsCleanup(false), count(0), SSEQs(), SBNKs(), SWARs()
 {
@@ -23,31 +26,40 @@ SDAT::SDAT() : filename(""), header(), SYMBOffset(0), SYMBSize(0), INFOOffset(0)
 	this->header.blocks = 3;
 }
 
+// Takes ownership of a file and makes the given entry point at it
+template<typename T, typename U> static inline void AddFile(std::vector<std::unique_ptr<T>> &files, std::unique_ptr<T> file, std::vector<U> &entries,
+	T *U::*entryFile, uint32_t entryNumber)
+{
+	file->entryNumber = entryNumber;
+	entries[entryNumber].*entryFile = file.get();
+	files.push_back(std::move(file));
+}
+
+// Maps each file to its position in its list, so the list does not need to be
+// searched every time an entry's file needs to be modified or moved
+template<typename T> static inline std::unordered_map<const T *, size_t> GetFilePositions(const std::vector<std::unique_ptr<T>> &files)
+{
+	std::unordered_map<const T *, size_t> positions;
+	positions.reserve(files.size());
+	for (size_t i = 0, num = files.size(); i < num; ++i)
+		positions[files[i].get()] = i;
+	return positions;
+}
+
 SDAT::SDAT(const SDAT &sdat) : filename(sdat.filename), header(sdat.header), SYMBOffset(sdat.SYMBOffset), SYMBSize(sdat.SYMBSize), INFOOffset(sdat.INFOOffset),
 	INFOSize(sdat.INFOSize), FATOffset(sdat.FATOffset), FATSize(sdat.FATSize), FILEOffset(sdat.FILEOffset), FILESize(sdat.FILESize), symbSection(sdat.symbSection),
 	infoSection(sdat.infoSection), fatSection(sdat.fatSection), symbSectionNeedsCleanup(sdat.symbSectionNeedsCleanup), count(sdat.count), SSEQs(), SBNKs(), SWARs()
 {
-	std::for_each(sdat.SSEQs.begin(), sdat.SSEQs.end(), [&](const SSEQList::value_type &sseq)
-	{
-		auto newSSEQ = std::unique_ptr<SSEQ>(new SSEQ(*sseq.get()));
-		auto &entry = this->infoSection.SEQrecord.entries[sseq->entryNumber];
-		entry.sseq = newSSEQ.get();
-		this->SSEQs.push_back(std::move(newSSEQ));
-	});
-	std::for_each(sdat.SBNKs.begin(), sdat.SBNKs.end(), [&](const SBNKList::value_type &sbnk)
-	{
-		auto newSBNK = std::unique_ptr<SBNK>(new SBNK(*sbnk.get()));
-		auto &entry = this->infoSection.BANKrecord.entries[sbnk->entryNumber];
-		entry.sbnk = newSBNK.get();
-		this->SBNKs.push_back(std::move(newSBNK));
-	});
-	std::for_each(sdat.SWARs.begin(), sdat.SWARs.end(), [&](const SWARList::value_type &swar)
-	{
-		auto newSWAR = std::unique_ptr<SWAR>(new SWAR(*swar.get()));
-		auto &entry = this->infoSection.WAVEARCrecord.entries[swar->entryNumber];
-		entry.swar = newSWAR.get();
-		this->SWARs.push_back(std::move(newSWAR));
-	});
+	this->CopyFiles(sdat, 0, 0, 0);
+}
+
+// The files are owned through pointers, so the entries still point at the right
+// files after they have been moved
+SDAT::SDAT(SDAT &&sdat) : filename(std::move(sdat.filename)), header(sdat.header), SYMBOffset(sdat.SYMBOffset), SYMBSize(sdat.SYMBSize), INFOOffset(sdat.INFOOffset),
+	INFOSize(sdat.INFOSize), FATOffset(sdat.FATOffset), FATSize(sdat.FATSize), FILEOffset(sdat.FILEOffset), FILESize(sdat.FILESize),
+	symbSection(std::move(sdat.symbSection)), infoSection(std::move(sdat.infoSection)), fatSection(std::move(sdat.fatSection)),
+	symbSectionNeedsCleanup(sdat.symbSectionNeedsCleanup), count(sdat.count), SSEQs(std::move(sdat.SSEQs)), SBNKs(std::move(sdat.SBNKs)), SWARs(std::move(sdat.SWARs))
+{
 }
 
 SDAT &SDAT::operator=(const SDAT &sdat)
@@ -72,34 +84,199 @@ SDAT &SDAT::operator=(const SDAT &sdat)
 		this->symbSectionNeedsCleanup = sdat.symbSectionNeedsCleanup;
 		this->count = sdat.count;
 
-		std::for_each(sdat.SSEQs.begin(), sdat.SSEQs.end(), [&](const SSEQList::value_type &sseq)
-		{
-			auto newSSEQ = std::unique_ptr<SSEQ>(new SSEQ(*sseq.get()));
-			auto &entry = this->infoSection.SEQrecord.entries[sseq->entryNumber];
-			entry.sseq = newSSEQ.get();
-			this->SSEQs.push_back(std::move(newSSEQ));
-		});
-		std::for_each(sdat.SBNKs.begin(), sdat.SBNKs.end(), [&](const SBNKList::value_type &sbnk)
-		{
-			auto newSBNK = std::unique_ptr<SBNK>(new SBNK(*sbnk.get()));
-			auto &entry = this->infoSection.BANKrecord.entries[sbnk->entryNumber];
-			entry.sbnk = newSBNK.get();
-			this->SBNKs.push_back(std::move(newSBNK));
-		});
-		std::for_each(sdat.SWARs.begin(), sdat.SWARs.end(), [&](const SWARList::value_type &swar)
-		{
-			auto newSWAR = std::unique_ptr<SWAR>(new SWAR(*swar.get()));
-			auto &entry = this->infoSection.WAVEARCrecord.entries[swar->entryNumber];
-			entry.swar = newSWAR.get();
-			this->SWARs.push_back(std::move(newSWAR));
-		});
+		this->SSEQs.clear();
+		this->SBNKs.clear();
+		this->SWARs.clear();
+		this->CopyFiles(sdat, 0, 0, 0);
 	}
 	return *this;
 }
 
-void SDAT::Read(const std::string &fn, PseudoReadFile &file, bool shouldFailOnMissingFiles)
+SDAT &SDAT::operator=(SDAT &&sdat)
+{
+	if (this != &sdat)
+	{
+		this->filename = std::move(sdat.filename);
+		this->header = sdat.header;
+		this->SYMBOffset = sdat.SYMBOffset;
+		this->SYMBSize = sdat.SYMBSize;
+		this->INFOOffset = sdat.INFOOffset;
+		this->INFOSize = sdat.INFOSize;
+		this->FATOffset = sdat.FATOffset;
+		this->FATSize = sdat.FATSize;
+		this->FILEOffset = sdat.FILEOffset;
+		this->FILESize = sdat.FILESize;
+
+		this->symbSection = std::move(sdat.symbSection);
+		this->infoSection = std::move(sdat.infoSection);
+		this->fatSection = std::move(sdat.fatSection);
+
+		this->symbSectionNeedsCleanup = sdat.symbSectionNeedsCleanup;
+		this->count = sdat.count;
+
+		this->SSEQs = std::move(sdat.SSEQs);
+		this->SBNKs = std::move(sdat.SBNKs);
+		this->SWARs = std::move(sdat.SWARs);
+	}
+	return *this;
+}
+
+// Copies the files of another SDAT into this one, the entries of the other SDAT
+// must already be in this SDAT, starting at the given entry numbers
+void SDAT::CopyFiles(const SDAT &other, uint32_t firstSEQ, uint32_t firstBANK, uint32_t firstWAVEARC)
+{
+	std::for_each(other.SSEQs.begin(), other.SSEQs.end(), [&](const SSEQList::value_type &sseq)
+	{
+		AddFile(this->SSEQs, std::unique_ptr<SSEQ>(new SSEQ(*sseq)), this->infoSection.SEQrecord.entries, &INFOEntrySEQ::sseq, firstSEQ + sseq->entryNumber);
+	});
+	std::for_each(other.SBNKs.begin(), other.SBNKs.end(), [&](const SBNKList::value_type &sbnk)
+	{
+		AddFile(this->SBNKs, std::unique_ptr<SBNK>(new SBNK(*sbnk)), this->infoSection.BANKrecord.entries, &INFOEntryBANK::sbnk, firstBANK + sbnk->entryNumber);
+	});
+	std::for_each(other.SWARs.begin(), other.SWARs.end(), [&](const SWARList::value_type &swar)
+	{
+		AddFile(this->SWARs, std::unique_ptr<SWAR>(new SWAR(*swar)), this->infoSection.WAVEARCrecord.entries, &INFOEntryWAVEARC::swar, firstWAVEARC + swar->entryNumber);
+	});
+}
+
+// Same as above, but takes the files from the other SDAT instead of copying them
+void SDAT::MoveFiles(SDAT &other, uint32_t firstSEQ, uint32_t firstBANK, uint32_t firstWAVEARC)
+{
+	std::for_each(other.SSEQs.begin(), other.SSEQs.end(), [&](SSEQList::value_type &sseq)
+	{
+		uint32_t entryNumber = firstSEQ + sseq->entryNumber;
+		AddFile(this->SSEQs, std::move(sseq), this->infoSection.SEQrecord.entries, &INFOEntrySEQ::sseq, entryNumber);
+	});
+	std::for_each(other.SBNKs.begin(), other.SBNKs.end(), [&](SBNKList::value_type &sbnk)
+	{
+		uint32_t entryNumber = firstBANK + sbnk->entryNumber;
+		AddFile(this->SBNKs, std::move(sbnk), this->infoSection.BANKrecord.entries, &INFOEntryBANK::sbnk, entryNumber);
+	});
+	std::for_each(other.SWARs.begin(), other.SWARs.end(), [&](SWARList::value_type &swar)
+	{
+		uint32_t entryNumber = firstWAVEARC + swar->entryNumber;
+		AddFile(this->SWARs, std::move(swar), this->infoSection.WAVEARCrecord.entries, &INFOEntryWAVEARC::swar, entryNumber);
+	});
+	other.SSEQs.clear();
+	other.SBNKs.clear();
+	other.SWARs.clear();
+}
+
+// The SDAT type followed by the magic of the standard header
+static const uint8_t SDATSignature[] = { 0x53, 0x44, 0x41, 0x54, 0xFF, 0xFE, 0x00, 0x01 };
+
+struct SDATScanChunk
+{
+	const uint8_t *data;
+	size_t size, start, end;
+	std::vector<uint32_t> offsets;
+
+	SDATScanChunk(const uint8_t *chunkData = nullptr, size_t dataSize = 0, size_t chunkStart = 0, size_t chunkEnd = 0) : data(chunkData), size(dataSize),
+		start(chunkStart), end(chunkEnd), offsets()
+	{
+	}
+};
+
+// Finds all the signatures starting within the chunk, a signature is allowed
+// to cross the end of the chunk. memchr is used to skip to each possible
+// first byte, as it is far faster than checking every byte.
+static void ScanForSDATSignature(SDATScanChunk &chunk)
+{
+	if (chunk.size < sizeof(SDATSignature))
+		return;
+	const uint8_t *curr = chunk.data + chunk.start;
+	const uint8_t *end = chunk.data + std::min(chunk.end, chunk.size - sizeof(SDATSignature) + 1);
+	while (curr < end)
+	{
+		curr = static_cast<const uint8_t *>(memchr(curr, SDATSignature[0], end - curr));
+		if (!curr)
+			break;
+		if (!memcmp(curr + 1, SDATSignature + 1, sizeof(SDATSignature) - 1))
+			chunk.offsets.push_back(curr - chunk.data);
+		++curr;
+	}
+}
+
+// Checks the parts of the SDAT header that SDAT::Read requires to be valid,
+// so that false positives can be rejected without trying to read them.
+// The positions are calculated the same way that PseudoReadView does.
+static bool SDATHeaderIsValid(const PseudoReadView &file, uint32_t offset)
+{
+	if (file.size < 0x32 || offset > file.size - 0x32)
+		return false;
+	auto SectionIsAt = [&](uint32_t sectionOffset, const char *type)
+	{
+		uint32_t pos = offset + sectionOffset;
+		return pos < file.size && file.size - pos >= 4 && !memcmp(&file.data[pos], type, 4);
+	};
+	uint32_t SYMBOffset = ReadLE<uint32_t>(&file.data[offset + 0x10]);
+	uint32_t INFOOffset = ReadLE<uint32_t>(&file.data[offset + 0x18]);
+	uint32_t FATOffset = ReadLE<uint32_t>(&file.data[offset + 0x20]);
+	return (!SYMBOffset || SectionIsAt(SYMBOffset, "SYMB")) && SectionIsAt(INFOOffset, "INFO") && SectionIsAt(FATOffset, "FAT ");
+}
+
+// Finds the offsets of everything within the data that looks like an SDAT, in
+// the order they appear.  Large data is split into chunks that are searched in
+// parallel.  The offsets are from the start of the data, ignoring startOffset.
+std::vector<uint32_t> SDAT::FindSDATs(const PseudoReadView &file)
 {
-	SDAT::failOnMissingFiles = true;
+	static const size_t minimumChunkSize = 32 * 1024 * 1024;
+
+	size_t numberOfChunks = std::max<size_t>(1, std::min(GetProcessorCount(), file.size / minimumChunkSize));
+	size_t chunkSize = file.size / numberOfChunks;
+	auto chunks = std::vector<SDATScanChunk>(numberOfChunks);
+	for (size_t i = 0; i < numberOfChunks; ++i)
+		chunks[i] = SDATScanChunk(file.data, file.size, i * chunkSize, i == numberOfChunks - 1 ? file.size : (i + 1) * chunkSize);
+
+	ParallelFor(numberOfChunks, numberOfChunks, [&](size_t i) { ScanForSDATSignature(chunks[i]); });
+
+	std::vector<uint32_t> offsets;
+	std::for_each(chunks.begin(), chunks.end(), [&](const SDATScanChunk &chunk)
+	{
+		std::copy_if(chunk.offsets.begin(), chunk.offsets.end(), std::back_inserter(offsets), [&](uint32_t offset) { return SDATHeaderIsValid(file, offset); });
+	});
+	return offsets;
+}
+
+// When files are checked but not read, only their header is verified, as it is
+// the only part of a file that failOnMissingFiles would ignore errors in
+static inline void SkipFileRead(INFOEntry &entry, const std::string &type, bool failOnMissingFiles)
+{
+	if (failOnMissingFiles)
+	{
+		PseudoReadView file(entry.fileData);
+		NDSStdHeader header;
+		header.Read(file);
+		header.Verify(type, 0x0100FEFF);
+	}
+	entry.fileNeedsRead = true;
+}
+
+// Widens the range to cover the files used by the entries of the record
+template<typename T> static inline void AddToFilesRange(const INFORecord<T> &record, const FATSection &fatSection, uint64_t &start, uint64_t &end)
+{
+	for (size_t i = 0, entries = record.entries.size(); i < entries; ++i)
+	{
+		if (!record.entryOffsets[i])
+			continue;
+		const auto &fatRecord = fatSection.records[record.entries[i].fileID];
+		start = std::min<uint64_t>(start, fatRecord.offset);
+		end = std::max<uint64_t>(end, static_cast<uint64_t>(fatRecord.offset) + fatRecord.size);
+	}
+}
+
+// If readFiles is false, only the SYMB, INFO and FAT sections are parsed, along
+// with the SSEQs, and the SBNKs and SWARs are created without being read and
+// their raw data is kept in their entries.  They will be read when they are
+// first retrieved through GetSBNK or GetSWAR (or all at once through
+// ReadFiles), until then their entry's pointer only gives their names.
+//
+// If readFiles is true, the files are read after all of them have been created,
+// spread across up to maxThreads threads (or one per processor if it is 0) if
+// there is enough data for it to be worth it.
+void SDAT::Read(const std::string &fn, PseudoReadView &file, bool failOnMissingFiles, bool readFiles, size_t maxThreads)
+{
+	static const size_t minimumFilesSizePerThread = 4 * 1024 * 1024;
 
 	this->filename = fn;
 
@@ -130,9 +307,22 @@ void SDAT::Read(const std::string &fn, PseudoReadFile &file, bool shouldFailOnMi
 	if (this->infoSection.SEQrecord.entries.empty())
 		throw std::logic_error("No SSEQ records found in SDAT");
 
-	SDAT::failOnMissingFiles = shouldFailOnMissingFiles;
+	// Load the part of the SDAT that holds the files into one buffer, the
+	// entries and the files will only refer to their own part of it
+	uint64_t filesStart = std::numeric_limits<uint64_t>::max(), filesEnd = 0;
+	AddToFilesRange(this->infoSection.SEQrecord, this->fatSection, filesStart, filesEnd);
+	AddToFilesRange(this->infoSection.BANKrecord, this->fatSection, filesStart, filesEnd);
+	AddToFilesRange(this->infoSection.WAVEARCrecord, this->fatSection, filesStart, filesEnd);
+	SharedBytes filesData;
+	if (filesEnd > filesStart)
+	{
+		file.pos = static_cast<uint32_t>(filesStart);
+		auto filesCursor = file.GetCursor(static_cast<size_t>(filesEnd - filesStart));
+		filesData = std::vector<uint8_t>(filesCursor.data, filesCursor.data + filesCursor.size);
+	}
 
-	// Read files
+	// Create files, reading them is left until they have all been created
+	std::vector<std::function<void ()>> fileReads;
 	for (size_t i = 0, entries = this->infoSection.SEQrecord.entries.size(); i < entries; ++i)
 	{
 		if (!this->infoSection.SEQrecord.entryOffsets[i])
@@ -147,14 +337,19 @@ void SDAT::Read(const std::string &fn, PseudoReadFile &file, bool shouldFailOnMi
 		}
 		entry.origFilename = origName;
 		entry.sdatNumber = this->filename;
-		file.pos = this->fatSection.records[fileID].offset;
-		entry.fileData.resize(this->fatSection.records[fileID].size, 0);
-		file.ReadLE(entry.fileData);
-		file.pos = this->fatSection.records[fileID].offset;
+		entry.fileData = SharedBytes(filesData, this->fatSection.records[fileID].offset - filesStart, this->fatSection.records[fileID].size);
 		auto newSSEQ = std::unique_ptr<SSEQ>(new SSEQ(name, origName));
 		entry.sseq = newSSEQ.get();
 		newSSEQ->entryNumber = i;
-		newSSEQ->Read(file);
+		// StripBanksAndWaveArcs keeps the original header of the SSEQs it changes,
+		// so the SSEQ is given the rest of the files in case its data goes past
+		// the end of its own file, as the data used to be read from the SDAT itself.
+		// Reading an SSEQ only finds where its data is, so it is never deferred,
+		// that way it gets the same data whether the other files are read or not.
+		uint32_t fileOffset = this->fatSection.records[fileID].offset - filesStart;
+		auto sseq = newSSEQ.get();
+		auto sseqData = SharedBytes(filesData, fileOffset, filesData.size() - fileOffset);
+		fileReads.push_back([=]() { sseq->Read(sseqData, failOnMissingFiles); });
 		this->SSEQs.push_back(std::move(newSSEQ));
 	}
 	for (size_t i = 0, entries = this->infoSection.BANKrecord.entries.size(); i < entries; ++i)
@@ -168,14 +363,18 @@ void SDAT::Read(const std::string &fn, PseudoReadFile &file, bool shouldFailOnMi
 			origName = this->symbSection.BANKrecord.entries[i];
 		entry.origFilename = origName;
 		entry.sdatNumber = this->filename;
-		file.pos = this->fatSection.records[fileID].offset;
-		entry.fileData.resize(this->fatSection.records[fileID].size, 0);
-		file.ReadLE(entry.fileData);
-		file.pos = this->fatSection.records[fileID].offset;
+		entry.fileData = SharedBytes(filesData, this->fatSection.records[fileID].offset - filesStart, this->fatSection.records[fileID].size);
 		auto newSBNK = std::unique_ptr<SBNK>(new SBNK(origName));
 		entry.sbnk = newSBNK.get();
 		newSBNK->entryNumber = i;
-		newSBNK->Read(file);
+		if (readFiles)
+		{
+			auto sbnk = newSBNK.get();
+			auto sbnkData = entry.fileData;
+			fileReads.push_back([=]() { sbnk->Read(sbnkData, failOnMissingFiles); });
+		}
+		else
+			SkipFileRead(entry, "SBNK", failOnMissingFiles);
 		this->SBNKs.push_back(std::move(newSBNK));
 	}
 	for (size_t i = 0, entries = this->infoSection.WAVEARCrecord.entries.size(); i < entries; ++i)
@@ -189,14 +388,18 @@ void SDAT::Read(const std::string &fn, PseudoReadFile &file, bool shouldFailOnMi
 			origName = this->symbSection.WAVEARCrecord.entries[i];
 		entry.origFilename = origName;
 		entry.sdatNumber = this->filename;
-		file.pos = this->fatSection.records[fileID].offset;
-		entry.fileData.resize(this->fatSection.records[fileID].size, 0);
-		file.ReadLE(entry.fileData);
-		file.pos = this->fatSection.records[fileID].offset;
+		entry.fileData = SharedBytes(filesData, this->fatSection.records[fileID].offset - filesStart, this->fatSection.records[fileID].size);
 		auto newSWAR = std::unique_ptr<SWAR>(new SWAR(origName));
 		entry.swar = newSWAR.get();
 		newSWAR->entryNumber = i;
-		newSWAR->Read(file);
+		if (readFiles)
+		{
+			auto swar = newSWAR.get();
+			auto swarData = entry.fileData;
+			fileReads.push_back([=]() { swar->Read(swarData, failOnMissingFiles); });
+		}
+		else
+			SkipFileRead(entry, "SWAR", failOnMissingFiles);
 		this->SWARs.push_back(std::move(newSWAR));
 	}
 	for (size_t i = 0, entries = this->infoSection.PLAYERrecord.entries.size(); i < entries; ++i)
@@ -210,10 +413,18 @@ void SDAT::Read(const std::string &fn, PseudoReadFile &file, bool shouldFailOnMi
 		entry.origFilename = origName;
 		entry.sdatNumber = this->filename;
 	}
+
+	// Read files, each one only writes to itself, so they can be read in any order
+	size_t numberOfThreads = std::max<size_t>(1, std::min(maxThreads ? maxThreads : GetProcessorCount(), filesData.size() / minimumFilesSizePerThread));
+	ParallelFor(fileReads.size(), numberOfThreads, [&](size_t i) { fileReads[i](); });
 }
 
+// FixOffsetsAndSizes must have been called beforehand, as the sizes and offsets
+// it calculates are used as-is here
 void SDAT::Write(PseudoWrite &file) const
 {
+	file.Reserve(this->header.fileSize);
+
 	// Write header
 	this->header.Write(file);
 	file.WriteLE(this->SYMBOffset);
@@ -363,6 +574,31 @@ SDAT &SDAT::operator+=(const SDAT &other)
 	if (this == &other)
 		return *this;
 
+	uint32_t origSEQcount = this->infoSection.SEQrecord.count, origBANKcount = this->infoSection.BANKrecord.count,
+		origWAVEARCcount = this->infoSection.WAVEARCrecord.count;
+	this->AppendEntries(other);
+	this->CopyFiles(other, origSEQcount, origBANKcount, origWAVEARCcount);
+
+	return *this;
+}
+
+// Appends another SDAT to this one, taking its files instead of copying them
+SDAT &SDAT::operator+=(SDAT &&other)
+{
+	if (this == &other)
+		return *this;
+
+	uint32_t origSEQcount = this->infoSection.SEQrecord.count, origBANKcount = this->infoSection.BANKrecord.count,
+		origWAVEARCcount = this->infoSection.WAVEARCrecord.count;
+	this->AppendEntries(other);
+	this->MoveFiles(other, origSEQcount, origBANKcount, origWAVEARCcount);
+
+	return *this;
+}
+
+// Appends the sections of another SDAT to this one, but not its files
+void SDAT::AppendEntries(const SDAT &other)
+{
 	uint32_t origSEQcount = this->infoSection.SEQrecord.count, origBANKcount = this->infoSection.BANKrecord.count,
 		origWAVEARCcount = this->infoSection.WAVEARCrecord.count, origPLAYERcount = this->infoSection.PLAYERrecord.count;
 	if (this->SYMBOffset || other.SYMBOffset)
@@ -413,13 +649,6 @@ SDAT &SDAT::operator+=(const SDAT &other)
 		thisSEQEntry.fileID += this->fatSection.count;
 		thisSEQEntry.bank += origBANKcount;
 		thisSEQEntry.ply += origPLAYERcount;
-		if (otherSEQEntry.sseq)
-		{
-			auto newSSEQ = std::unique_ptr<SSEQ>(new SSEQ(*otherSEQEntry.sseq));
-			thisSEQEntry.sseq = newSSEQ.get();
-			newSSEQ->entryNumber = i;
-			this->SSEQs.push_back(std::move(newSSEQ));
-		}
 	}
 
 	this->infoSection.BANKrecord.count = this->infoSection.BANKrecord.count + other.infoSection.BANKrecord.count;
@@ -436,13 +665,6 @@ SDAT &SDAT::operator+=(const SDAT &other)
 		for (size_t j = 0; j < 4; ++j)
 			if (thisBANKEntry.waveArc[j] != 0xFFFF)
 				thisBANKEntry.waveArc[j] += origWAVEARCcount;
-		if (otherBANKEntry.sbnk)
-		{
-			auto newSBNK = std::unique_ptr<SBNK>(new SBNK(*otherBANKEntry.sbnk));
-			thisBANKEntry.sbnk = newSBNK.get();
-			newSBNK->entryNumber = i;
-			this->SBNKs.push_back(std::move(newSBNK));
-		}
 	}
 
 	this->infoSection.WAVEARCrecord.count = this->infoSection.WAVEARCrecord.count + other.infoSection.WAVEARCrecord.count;
@@ -456,13 +678,6 @@ SDAT &SDAT::operator+=(const SDAT &other)
 		auto &otherWAVEARCEntry = other.infoSection.WAVEARCrecord.entries[i - origWAVEARCcount];
 		thisWAVEARCEntry = otherWAVEARCEntry;
 		thisWAVEARCEntry.fileID += this->fatSection.count;
-		if (otherWAVEARCEntry.swar)
-		{
-			auto newSWAR = std::unique_ptr<SWAR>(new SWAR(*otherWAVEARCEntry.swar));
-			thisWAVEARCEntry.swar = newSWAR.get();
-			newSWAR->entryNumber = i;
-			this->SWARs.push_back(std::move(newSWAR));
-		}
 	}
 
 	this->infoSection.PLAYERrecord.count = this->infoSection.PLAYERrecord.count + other.infoSection.PLAYERrecord.count;
@@ -479,32 +694,215 @@ SDAT &SDAT::operator+=(const SDAT &other)
 	std::copy(other.fatSection.records.begin(), other.fatSection.records.end(), this->fatSection.records.begin() + origFileCount);
 
 	++this->count;
+}
 
-	return *this;
+static inline void ResizeRecord(SYMBRecord &record, uint32_t count)
+{
+	record.count = count;
+	record.entryOffsets.resize(count, 0);
+	record.entries.resize(count, "");
 }
 
-typedef std::map<uint32_t, std::vector<uint32_t>> Duplicates;
+template<typename T> static inline void ResizeRecord(INFORecord<T> &record, uint32_t count)
+{
+	record.count = count;
+	record.entryOffsets.resize(count, 0);
+	record.entries.resize(count);
+}
 
-// This is to find a value in a vector out of a map
-static struct FindInVector : std::binary_function<Duplicates::value_type, uint32_t, bool>
+// Appends all of the given SDATs to this one, taking their files and entries.
+// The result is the same as appending them one at a time with operator+=, but
+// every section and list is only resized once.
+void SDAT::Merge(std::vector<SDAT> &&sdats)
 {
-	bool operator()(const Duplicates::value_type &a, uint32_t b) const
+	if (sdats.empty())
+		return;
+
+	uint32_t SEQcount = this->infoSection.SEQrecord.count, BANKcount = this->infoSection.BANKrecord.count, WAVEARCcount = this->infoSection.WAVEARCrecord.count,
+		PLAYERcount = this->infoSection.PLAYERrecord.count, fileCount = this->fatSection.count;
+	size_t SSEQcount = this->SSEQs.size(), SBNKcount = this->SBNKs.size(), SWARcount = this->SWARs.size();
+	bool hasSYMB = !!this->SYMBOffset;
+	std::for_each(sdats.begin(), sdats.end(), [&](const SDAT &sdat)
+	{
+		SEQcount += sdat.infoSection.SEQrecord.count;
+		BANKcount += sdat.infoSection.BANKrecord.count;
+		WAVEARCcount += sdat.infoSection.WAVEARCrecord.count;
+		PLAYERcount += sdat.infoSection.PLAYERrecord.count;
+		fileCount += sdat.fatSection.count;
+		SSEQcount += sdat.SSEQs.size();
+		SBNKcount += sdat.SBNKs.size();
+		SWARcount += sdat.SWARs.size();
+		hasSYMB = hasSYMB || sdat.SYMBOffset;
+	});
+
+	uint32_t firstSEQ = this->infoSection.SEQrecord.count, firstBANK = this->infoSection.BANKrecord.count, firstWAVEARC = this->infoSection.WAVEARCrecord.count,
+		firstPLAYER = this->infoSection.PLAYERrecord.count, firstFile = this->fatSection.count;
+
+	if (hasSYMB)
 	{
-		return std::find(a.second.begin(), a.second.end(), b) != a.second.end();
+		ResizeRecord(this->symbSection.SEQrecord, SEQcount);
+		ResizeRecord(this->symbSection.BANKrecord, BANKcount);
+		ResizeRecord(this->symbSection.WAVEARCrecord, WAVEARCcount);
+		ResizeRecord(this->symbSection.PLAYERrecord, PLAYERcount);
+
+		this->symbSectionNeedsCleanup = true;
+
+		this->SYMBOffset = 0x40;
 	}
-} findInVector;
+
+	ResizeRecord(this->infoSection.SEQrecord, SEQcount);
+	ResizeRecord(this->infoSection.BANKrecord, BANKcount);
+	ResizeRecord(this->infoSection.WAVEARCrecord, WAVEARCcount);
+	ResizeRecord(this->infoSection.PLAYERrecord, PLAYERcount);
+
+	this->fatSection.count = fileCount;
+	this->fatSection.records.resize(fileCount);
+
+	this->SSEQs.reserve(SSEQcount);
+	this->SBNKs.reserve(SBNKcount);
+	this->SWARs.reserve(SWARcount);
+
+	std::for_each(sdats.begin(), sdats.end(), [&](SDAT &sdat)
+	{
+		if (sdat.SYMBOffset)
+		{
+			std::move(sdat.symbSection.SEQrecord.entries.begin(), sdat.symbSection.SEQrecord.entries.end(), this->symbSection.SEQrecord.entries.begin() + firstSEQ);
+			std::move(sdat.symbSection.BANKrecord.entries.begin(), sdat.symbSection.BANKrecord.entries.end(), this->symbSection.BANKrecord.entries.begin() + firstBANK);
+			std::move(sdat.symbSection.WAVEARCrecord.entries.begin(), sdat.symbSection.WAVEARCrecord.entries.end(),
+				this->symbSection.WAVEARCrecord.entries.begin() + firstWAVEARC);
+			std::move(sdat.symbSection.PLAYERrecord.entries.begin(), sdat.symbSection.PLAYERrecord.entries.end(),
+				this->symbSection.PLAYERrecord.entries.begin() + firstPLAYER);
+		}
+
+		const auto &SEQrecord = sdat.infoSection.SEQrecord;
+		std::copy(SEQrecord.entryOffsets.begin(), SEQrecord.entryOffsets.end(), this->infoSection.SEQrecord.entryOffsets.begin() + firstSEQ);
+		for (uint32_t i = 0; i < SEQrecord.count; ++i)
+		{
+			auto &SEQEntry = this->infoSection.SEQrecord.entries[firstSEQ + i];
+			SEQEntry = std::move(sdat.infoSection.SEQrecord.entries[i]);
+			SEQEntry.fileID += firstFile;
+			SEQEntry.bank += firstBANK;
+			SEQEntry.ply += firstPLAYER;
+		}
+
+		const auto &BANKrecord = sdat.infoSection.BANKrecord;
+		std::copy(BANKrecord.entryOffsets.begin(), BANKrecord.entryOffsets.end(), this->infoSection.BANKrecord.entryOffsets.begin() + firstBANK);
+		for (uint32_t i = 0; i < BANKrecord.count; ++i)
+		{
+			auto &BANKEntry = this->infoSection.BANKrecord.entries[firstBANK + i];
+			BANKEntry = std::move(sdat.infoSection.BANKrecord.entries[i]);
+			BANKEntry.fileID += firstFile;
+			for (size_t j = 0; j < 4; ++j)
+				if (BANKEntry.waveArc[j] != 0xFFFF)
+					BANKEntry.waveArc[j] += firstWAVEARC;
+		}
+
+		const auto &WAVEARCrecord = sdat.infoSection.WAVEARCrecord;
+		std::copy(WAVEARCrecord.entryOffsets.begin(), WAVEARCrecord.entryOffsets.end(), this->infoSection.WAVEARCrecord.entryOffsets.begin() + firstWAVEARC);
+		for (uint32_t i = 0; i < WAVEARCrecord.count; ++i)
+		{
+			auto &WAVEARCEntry = this->infoSection.WAVEARCrecord.entries[firstWAVEARC + i];
+			WAVEARCEntry = std::move(sdat.infoSection.WAVEARCrecord.entries[i]);
+			WAVEARCEntry.fileID += firstFile;
+		}
+
+		const auto &PLAYERrecord = sdat.infoSection.PLAYERrecord;
+		std::copy(PLAYERrecord.entryOffsets.begin(), PLAYERrecord.entryOffsets.end(), this->infoSection.PLAYERrecord.entryOffsets.begin() + firstPLAYER);
+		std::move(sdat.infoSection.PLAYERrecord.entries.begin(), sdat.infoSection.PLAYERrecord.entries.end(), this->infoSection.PLAYERrecord.entries.begin() + firstPLAYER);
+
+		std::copy(sdat.fatSection.records.begin(), sdat.fatSection.records.end(), this->fatSection.records.begin() + firstFile);
+
+		this->MoveFiles(sdat, firstSEQ, firstBANK, firstWAVEARC);
+
+		firstSEQ += SEQrecord.count;
+		firstBANK += BANKrecord.count;
+		firstWAVEARC += WAVEARCrecord.count;
+		firstPLAYER += PLAYERrecord.count;
+		firstFile += sdat.fatSection.count;
+
+		++this->count;
+	});
+
+	sdats.clear();
+}
+
+// The duplicates found for one type of entry.  Each entry being kept maps to
+// the entries that are duplicates of it, and each of those duplicates maps back
+// to the entry being kept in its place.
+struct Duplicates
+{
+	std::map<uint32_t, std::vector<uint32_t>> kept;
+	std::unordered_map<uint32_t, uint32_t> keptFor;
+
+	bool IsDuplicate(uint32_t entry) const
+	{
+		return !!this->keptFor.count(entry);
+	}
+};
 
 // Returns the non-duplicate number of an SBNK or SWAR
 static inline uint16_t GetNonDupNumber(uint16_t orig, const Duplicates &duplicates)
 {
-	if (duplicates.count(orig))
-		return orig;
-	auto duplicate = std::find_if(duplicates.begin(), duplicates.end(), std::bind2nd(findInVector, orig));
-	if (duplicate != duplicates.end())
-		return duplicate->first;
+	auto duplicate = duplicates.keptFor.find(orig);
+	if (duplicate != duplicates.keptFor.end())
+		return duplicate->second;
 	return orig;
 }
 
+// A fast (but not cryptographic) 64-bit hash of a block of data, used to
+// bucket entries so that only entries with the same hash need a full compare
+static inline uint64_t HashData(const uint8_t *data, size_t size, uint64_t hash = 0)
+{
+	static const uint64_t multiplier = 0x9E3779B97F4A7C15ULL;
+	hash = (hash ^ size) * multiplier;
+	size_t i = 0;
+	for (; i + 8 <= size; i += 8)
+	{
+		uint64_t word;
+		memcpy(&word, data + i, 8);
+		hash = (hash ^ word) * multiplier;
+		hash ^= hash >> 29;
+	}
+	if (i < size)
+	{
+		uint64_t word = 0;
+		memcpy(&word, data + i, size - i);
+		hash = (hash ^ word) * multiplier;
+	}
+	return hash ^ (hash >> 32);
+}
+
+static inline uint64_t HashData(const SharedBytes &data, uint64_t hash = 0)
+{
+	return HashData(data.data(), data.size(), hash);
+}
+
+// Finds the duplicates among the first count entries, skipping those that
+// include rejects.  Entries are bucketed by their hash, so an entry is only
+// compared in full (with same) to the kept entries that share its hash.  The
+// entries are gone through in order, making the first of a set of identical
+// entries the one that is kept.  An entry that canBeKept rejects can still be
+// a duplicate of an earlier entry, but is never kept in place of a later one.
+template<typename Include, typename CanBeKept, typename Hash, typename Same> static void FindDuplicates(uint32_t count, Include include, CanBeKept canBeKept,
+	Hash hash, Same same, Duplicates &duplicates)
+{
+	std::unordered_map<uint64_t, std::vector<uint32_t>> buckets;
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		if (!include(i))
+			continue;
+		auto &bucket = buckets[hash(i)];
+		auto kept = std::find_if(bucket.begin(), bucket.end(), [&](uint32_t j) { return same(j, i); });
+		if (kept != bucket.end())
+		{
+			duplicates.kept[*kept].push_back(i);
+			duplicates.keptFor[i] = *kept;
+		}
+		else if (canBeKept(i))
+			bucket.push_back(i);
+	}
+}
+
 // Output a vector with comma separation
 template<typename T, typename U> static inline void OutputVector(const std::vector<T> &vec, const std::vector<U> &nameSource, bool multipleSDATs,
 	const std::string &outputPrefix = " ", size_t columnWidth = 80)
@@ -544,162 +942,107 @@ template<typename T, typename U, typename V> static inline void OutputMap(const
 // removes anything that is not an SSEQ, SBNK, or SWAR.
 void SDAT::Strip(const IncOrExc &includesAndExcludes, bool verbose, bool removedExcluded)
 {
+	auto canAlwaysBeKept = [](uint32_t) { return true; };
+
 	// Search for duplicate PLAYERs
 	Duplicates duplicatePLAYERs;
 
-	for (size_t i = 0, entries = this->infoSection.PLAYERrecord.entries.size(); i < entries; ++i)
+	const auto &PLAYERrecord = this->infoSection.PLAYERrecord;
+	FindDuplicates(PLAYERrecord.entries.size(), [&](uint32_t i)
 	{
-		if (!this->infoSection.PLAYERrecord.entryOffsets[i]) // Skip empty offsets
-			continue;
-		if (std::find_if(duplicatePLAYERs.begin(), duplicatePLAYERs.end(), std::bind2nd(findInVector, i)) != duplicatePLAYERs.end()) // Already added as a duplicate of another PLAYER, skip it
-			continue;
-		auto &ientry = this->infoSection.PLAYERrecord.entries[i];
-		uint16_t imaxSeqs = ientry.maxSeqs;
-		uint16_t ichannelMask = ientry.channelMask;
-		uint32_t iheapSize = ientry.heapSize;
-		std::vector<uint32_t> duplicates;
-		for (size_t j = i + 1; j < entries; ++j)
-		{
-			if (!this->infoSection.PLAYERrecord.entryOffsets[j]) // Skip empty offsets
-				continue;
-			auto &jentry = this->infoSection.PLAYERrecord.entries[j];
-			if (imaxSeqs != jentry.maxSeqs || ichannelMask != jentry.channelMask || iheapSize != jentry.heapSize) // Player data is different, not duplicates, skip it
-				continue;
-			duplicates.push_back(j);
-		}
-		if (!duplicates.empty())
-			duplicatePLAYERs.insert(std::make_pair(i, duplicates));
-	}
+		return !!PLAYERrecord.entryOffsets[i]; // Skip empty offsets
+	}, canAlwaysBeKept, [&](uint32_t i)
+	{
+		const auto &entry = PLAYERrecord.entries[i];
+		return (static_cast<uint64_t>(entry.maxSeqs) << 48) ^ (static_cast<uint64_t>(entry.channelMask) << 32) ^ entry.heapSize;
+	}, [&](uint32_t i, uint32_t j)
+	{
+		const auto &ientry = PLAYERrecord.entries[i], &jentry = PLAYERrecord.entries[j];
+		return ientry.maxSeqs == jentry.maxSeqs && ientry.channelMask == jentry.channelMask && ientry.heapSize == jentry.heapSize;
+	}, duplicatePLAYERs);
 
 	// Search for duplicate SWARs
 	Duplicates duplicateSWARs;
 
-	for (size_t i = 0, entries = this->infoSection.WAVEARCrecord.entries.size(); i < entries; ++i)
+	const auto &WAVEARCrecord = this->infoSection.WAVEARCrecord;
+	FindDuplicates(WAVEARCrecord.entries.size(), [&](uint32_t i)
 	{
-		if (!this->infoSection.WAVEARCrecord.entryOffsets[i]) // Skip empty offsets
-			continue;
-		if (std::find_if(duplicateSWARs.begin(), duplicateSWARs.end(), std::bind2nd(findInVector, i)) != duplicateSWARs.end()) // Already added as a duplicate of another SWAR, skip it
-			continue;
-		auto &ientry = this->infoSection.WAVEARCrecord.entries[i];
-		uint16_t ifileID = ientry.fileID;
-		uint32_t ifileSize = this->fatSection.records[ifileID].size;
-		const auto &ifileData = ientry.fileData;
-		std::vector<uint32_t> duplicates;
-		for (size_t j = i + 1; j < entries; ++j)
-		{
-			if (!this->infoSection.WAVEARCrecord.entryOffsets[j]) // Skip empty offsets
-				continue;
-			auto &jentry = this->infoSection.WAVEARCrecord.entries[j];
-			uint16_t jfileID = jentry.fileID;
-			uint32_t jfileSize = this->fatSection.records[jfileID].size;
-			if (ifileSize != jfileSize) // Files sizes are different, not duplicates, skip it
-				continue;
-			if (ifileData != jentry.fileData) // File data is different, not duplicates, skip it
-				continue;
-			duplicates.push_back(j);
-		}
-		if (!duplicates.empty())
-			duplicateSWARs.insert(std::make_pair(i, duplicates));
-	}
+		return !!WAVEARCrecord.entryOffsets[i]; // Skip empty offsets
+	}, canAlwaysBeKept, [&](uint32_t i)
+	{
+		const auto &entry = WAVEARCrecord.entries[i];
+		return HashData(entry.fileData, this->fatSection.records[entry.fileID].size);
+	}, [&](uint32_t i, uint32_t j)
+	{
+		const auto &ientry = WAVEARCrecord.entries[i], &jentry = WAVEARCrecord.entries[j];
+		return this->fatSection.records[ientry.fileID].size == this->fatSection.records[jentry.fileID].size && ientry.fileData == jentry.fileData;
+	}, duplicateSWARs);
 
-	// Search for duplicate SBNKs
+	// Search for duplicate SBNKs, the wave archives they use also have to be the same (after removing duplicate SWARs)
 	Duplicates duplicateSBNKs;
 
-	for (size_t i = 0, entries = this->infoSection.BANKrecord.entries.size(); i < entries; ++i)
+	const auto &BANKrecord = this->infoSection.BANKrecord;
+	auto nonDupWaveArcs = std::vector<std::vector<uint16_t>>(BANKrecord.entries.size(), std::vector<uint16_t>(4, 0xFFFF));
+	FindDuplicates(BANKrecord.entries.size(), [&](uint32_t i)
 	{
-		if (!this->infoSection.BANKrecord.entryOffsets[i]) // Skip empty offsets
-			continue;
-		if (std::find_if(duplicateSBNKs.begin(), duplicateSBNKs.end(), std::bind2nd(findInVector, i)) != duplicateSBNKs.end()) // Already added as a duplicate of another SBNK, skip it
-			continue;
-		auto &ientry = this->infoSection.BANKrecord.entries[i];
-		uint16_t ifileID = ientry.fileID;
-		uint32_t ifileSize = this->fatSection.records[ifileID].size;
-		auto iwaveArc = std::vector<uint16_t>(4, 0xFFFF);
+		return !!BANKrecord.entryOffsets[i]; // Skip empty offsets
+	}, canAlwaysBeKept, [&](uint32_t i)
+	{
+		const auto &entry = BANKrecord.entries[i];
+		auto &waveArcs = nonDupWaveArcs[i];
 		for (int k = 0; k < 4; ++k)
 		{
-			uint16_t waveArc = ientry.waveArc[k];
+			uint16_t waveArc = entry.waveArc[k];
 			if (waveArc != 0xFFFF)
-				iwaveArc[k] = GetNonDupNumber(waveArc, duplicateSWARs);
-		}
-		const auto &ifileData = ientry.fileData;
-		std::vector<uint32_t> duplicates;
-		for (size_t j = i + 1; j < entries; ++j)
-		{
-			if (!this->infoSection.BANKrecord.entryOffsets[j]) // Skip empty offsets
-				continue;
-			auto &jentry = this->infoSection.BANKrecord.entries[j];
-			uint16_t jfileID = jentry.fileID;
-			uint32_t jfileSize = this->fatSection.records[jfileID].size;
-			if (ifileSize != jfileSize) // File sizes are different, not duplicates, skip it
-				continue;
-			if (ifileData != jentry.fileData) // File data is different, not duplicates, skip it
-				continue;
-			auto jwaveArc = std::vector<uint16_t>(4, 0xFFFF);
-			for (int k = 0; k < 4; ++k)
-			{
-				uint16_t waveArc = jentry.waveArc[k];
-				if (waveArc != 0xFFFF)
-					jwaveArc[k] = GetNonDupNumber(waveArc, duplicateSWARs);
-			}
-			if (iwaveArc != jwaveArc) // Wave archives are different, not duplicates, skip it
-				continue;
-			duplicates.push_back(j);
+				waveArcs[k] = GetNonDupNumber(waveArc, duplicateSWARs);
 		}
-		if (!duplicates.empty())
-			duplicateSBNKs.insert(std::make_pair(i, duplicates));
-	}
-
-	// Search for duplicate SSEQs, as well as ones that the user requested to exclude
+		uint64_t hash = HashData(entry.fileData, this->fatSection.records[entry.fileID].size);
+		return HashData(reinterpret_cast<const uint8_t *>(&waveArcs[0]), 4 * sizeof(uint16_t), hash);
+	}, [&](uint32_t i, uint32_t j)
+	{
+		const auto &ientry = BANKrecord.entries[i], &jentry = BANKrecord.entries[j];
+		return this->fatSection.records[ientry.fileID].size == this->fatSection.records[jentry.fileID].size && ientry.fileData == jentry.fileData &&
+			nonDupWaveArcs[i] == nonDupWaveArcs[j];
+	}, duplicateSBNKs);
+
+	// Search for duplicate SSEQs, as well as ones that the user requested to exclude.
+	// An excluded SSEQ can be a duplicate of an earlier SSEQ, but is never kept in
+	// place of a later one.
 	Duplicates duplicateSSEQs;
 	std::vector<uint32_t> excludedSSEQs;
 
-	for (int i = 0, entries = this->infoSection.SEQrecord.entries.size(); i < entries; ++i)
+	const auto &SEQrecord = this->infoSection.SEQrecord;
+	auto isExcludedSSEQ = std::vector<bool>(SEQrecord.entries.size(), false);
+	KeepMatcher keepMatcher(includesAndExcludes);
+	for (uint32_t i = 0, entries = SEQrecord.entries.size(); i < entries; ++i)
 	{
-		if (!this->infoSection.SEQrecord.entryOffsets[i]) // Skip empty offsets
-			continue;
-		if (std::find(excludedSSEQs.begin(), excludedSSEQs.end(), i) != excludedSSEQs.end()) // Skip already excluded files
+		if (!SEQrecord.entryOffsets[i]) // Skip empty offsets
 			continue;
-		auto &ientry = this->infoSection.SEQrecord.entries[i];
-		uint16_t ifileID = ientry.fileID;
-		std::string ifilename = ientry.sseq->origFilename;
-		auto alreadyFound = std::find_if(duplicateSSEQs.begin(), duplicateSSEQs.end(), std::bind2nd(findInVector, i));
-		if (IncludeFilename(ifilename, ientry.sdatNumber, includesAndExcludes) == KEEP_EXCLUDE)
+		const auto &entry = SEQrecord.entries[i];
+		if (keepMatcher.Match(entry.sseq->origFilename, entry.sdatNumber) == KEEP_EXCLUDE)
 		{
 			excludedSSEQs.push_back(i);
-			if (alreadyFound != duplicateSSEQs.end())
-			{
-				auto duplicates = alreadyFound->second;
-				duplicates.erase(std::find(duplicates.begin(), duplicates.end(), i));
-			}
-			continue;
-		}
-
-		if (alreadyFound != duplicateSSEQs.end()) // Already added as a duplicate of another SSEQ, skip it
-			continue;
-		uint32_t ifileSize = this->fatSection.records[ifileID].size;
-		uint16_t inonDupBank = GetNonDupNumber(ientry.bank, duplicateSBNKs);
-		const auto &ifileData = ientry.fileData;
-		std::vector<uint32_t> duplicates;
-		for (int j = i + 1; j < entries; ++j)
-		{
-			if (!this->infoSection.SEQrecord.entryOffsets[j]) // Skip empty offsets
-				continue;
-			auto &jentry = this->infoSection.SEQrecord.entries[j];
-			uint16_t jfileID = jentry.fileID;
-			uint32_t jfileSize = this->fatSection.records[jfileID].size;
-			if (ifileSize != jfileSize) // File sizes are different, not duplicates, skip it
-				continue;
-			if (ifileData != jentry.fileData) // File data is different, not duplicates, skip it
-				continue;
-			uint16_t jnonDupBank = GetNonDupNumber(jentry.bank, duplicateSBNKs);
-			if (inonDupBank != jnonDupBank) // Banks are different, not duplicates, skip it
-				continue;
-			duplicates.push_back(j);
+			isExcludedSSEQ[i] = true;
 		}
-		if (!duplicates.empty())
-			duplicateSSEQs.insert(std::make_pair(i, duplicates));
 	}
 
+	FindDuplicates(SEQrecord.entries.size(), [&](uint32_t i)
+	{
+		return !!SEQrecord.entryOffsets[i]; // Skip empty offsets
+	}, [&](uint32_t i)
+	{
+		return !isExcludedSSEQ[i];
+	}, [&](uint32_t i)
+	{
+		const auto &entry = SEQrecord.entries[i];
+		return HashData(entry.fileData, (static_cast<uint64_t>(GetNonDupNumber(entry.bank, duplicateSBNKs)) << 32) | this->fatSection.records[entry.fileID].size);
+	}, [&](uint32_t i, uint32_t j)
+	{
+		const auto &ientry = SEQrecord.entries[i], &jentry = SEQrecord.entries[j];
+		return this->fatSection.records[ientry.fileID].size == this->fatSection.records[jentry.fileID].size && ientry.fileData == jentry.fileData &&
+			GetNonDupNumber(ientry.bank, duplicateSBNKs) == GetNonDupNumber(jentry.bank, duplicateSBNKs);
+	}, duplicateSSEQs);
+
 	// Determine which SSEQs to keep
 	std::vector<uint32_t> SSEQsToKeep;
 
@@ -707,20 +1050,21 @@ void SDAT::Strip(const IncOrExc &includesAndExcludes, bool verbose, bool removed
 	{
 		if (!this->infoSection.SEQrecord.entryOffsets[i]) // Skip empty offsets
 			continue;
-		if (std::find_if(duplicateSSEQs.begin(), duplicateSSEQs.end(), std::bind2nd(findInVector, i)) != duplicateSSEQs.end()) // Skip if it is a duplicate
+		if (duplicateSSEQs.IsDuplicate(i)) // Skip if it is a duplicate
 			continue;
-		if (removedExcluded && std::find(excludedSSEQs.begin(), excludedSSEQs.end(), i) != excludedSSEQs.end()) // Skip if the user requested it be excluded
+		if (removedExcluded && isExcludedSSEQ[i]) // Skip if the user requested it be excluded
 			continue;
 		SSEQsToKeep.push_back(i);
 	}
 
 	// Determine which SBNKs to keep and are being used by the SSEQs we are keeping
 	std::vector<uint32_t> SBNKsToKeep;
+	std::unordered_set<uint16_t> SBNKsSeen;
 
 	for (size_t i = 0, num = SSEQsToKeep.size(); i < num; ++i)
 	{
 		uint16_t nonDupBank = GetNonDupNumber(this->infoSection.SEQrecord.entries[SSEQsToKeep[i]].bank, duplicateSBNKs);
-		if (std::find(SBNKsToKeep.begin(), SBNKsToKeep.end(), nonDupBank) != SBNKsToKeep.end()) // If the SBNK is already in the list to keep, then don't add it again
+		if (!SBNKsSeen.insert(nonDupBank).second) // If the SBNK is already in the list to keep, then don't add it again
 			continue;
 		SBNKsToKeep.push_back(nonDupBank);
 	}
@@ -730,6 +1074,7 @@ void SDAT::Strip(const IncOrExc &includesAndExcludes, bool verbose, bool removed
 
 	// Determine which SWARs to keep and are being used by the SBNKs we are keeping
 	std::vector<uint32_t> SWARsToKeep;
+	std::unordered_set<uint16_t> SWARsSeen;
 
 	for (size_t i = 0, num = SBNKsToKeep.size(); i < num; ++i)
 		for (int j = 0; j < 4; ++j)
@@ -738,7 +1083,7 @@ void SDAT::Strip(const IncOrExc &includesAndExcludes, bool verbose, bool removed
 			if (waveArc == 0xFFFF) // Don't bother with the wave archive if it's 0xFFFF, that is the designator for no wave archive
 				continue;
 			uint16_t nonDupWaveArc = GetNonDupNumber(waveArc, duplicateSWARs);
-			if (std::find(SWARsToKeep.begin(), SWARsToKeep.end(), nonDupWaveArc) != SWARsToKeep.end()) // If the SWAR is already in the list to keep, then don't add it again
+			if (!SWARsSeen.insert(nonDupWaveArc).second) // If the SWAR is already in the list to keep, then don't add it again
 				continue;
 			SWARsToKeep.push_back(nonDupWaveArc);
 		}
@@ -748,12 +1093,13 @@ void SDAT::Strip(const IncOrExc &includesAndExcludes, bool verbose, bool removed
 
 	// Determine which PLAYERs to keep and are being used by SSEQs we are keeping
 	std::vector<uint32_t> PLAYERsToKeep;
+	std::unordered_set<uint16_t> PLAYERsSeen;
 
 	size_t numPlayers = this->infoSection.PLAYERrecord.entries.size();
 	for (size_t i = 0, num = SSEQsToKeep.size(); i < num; ++i)
 	{
 		uint16_t nonDupPlayer = GetNonDupNumber(this->infoSection.SEQrecord.entries[SSEQsToKeep[i]].ply, duplicatePLAYERs);
-		if (std::find(PLAYERsToKeep.begin(), PLAYERsToKeep.end(), nonDupPlayer) != PLAYERsToKeep.end()) // If the PLAYER is already in the list to keep, then don't add it again
+		if (!PLAYERsSeen.insert(nonDupPlayer).second) // If the PLAYER is already in the list to keep, then don't add it again
 			continue;
 		if (numPlayers <= nonDupPlayer) // Somehow, some SDATs can have no players...
 			continue;
@@ -773,31 +1119,31 @@ void SDAT::Strip(const IncOrExc &includesAndExcludes, bool verbose, bool removed
 			std::cout << "\n";
 		}
 
-		if (!duplicateSSEQs.empty())
+		if (!duplicateSSEQs.kept.empty())
 		{
-			std::cout << "The following SSEQ" << (duplicateSSEQs.size() != 1 ? "s" : "") << " had duplicates, the duplicates will be removed:\n";
-			OutputMap(duplicateSSEQs, this->infoSection.SEQrecord.entries, this->count > 1);
+			std::cout << "The following SSEQ" << (duplicateSSEQs.kept.size() != 1 ? "s" : "") << " had duplicates, the duplicates will be removed:\n";
+			OutputMap(duplicateSSEQs.kept, this->infoSection.SEQrecord.entries, this->count > 1);
 			std::cout << "\n";
 		}
 
-		if (!duplicateSBNKs.empty())
+		if (!duplicateSBNKs.kept.empty())
 		{
-			std::cout << "The following SBNK" << (duplicateSBNKs.size() != 1 ? "s" : "") << " had duplicates, the duplicates will be removed:\n";
-			OutputMap(duplicateSBNKs, this->infoSection.BANKrecord.entries, this->count > 1);
+			std::cout << "The following SBNK" << (duplicateSBNKs.kept.size() != 1 ? "s" : "") << " had duplicates, the duplicates will be removed:\n";
+			OutputMap(duplicateSBNKs.kept, this->infoSection.BANKrecord.entries, this->count > 1);
 			std::cout << "\n";
 		}
 
-		if (!duplicateSWARs.empty())
+		if (!duplicateSWARs.kept.empty())
 		{
-			std::cout << "The following SWAR" << (duplicateSWARs.size() != 1 ? "s" : "") << " had duplicates, the duplicates will be removed:\n";
-			OutputMap(duplicateSWARs, this->infoSection.WAVEARCrecord.entries, this->count > 1);
+			std::cout << "The following SWAR" << (duplicateSWARs.kept.size() != 1 ? "s" : "") << " had duplicates, the duplicates will be removed:\n";
+			OutputMap(duplicateSWARs.kept, this->infoSection.WAVEARCrecord.entries, this->count > 1);
 			std::cout << "\n";
 		}
 
-		if (!duplicatePLAYERs.empty())
+		if (!duplicatePLAYERs.kept.empty())
 		{
-			std::cout << "The following PLAYER" << (duplicatePLAYERs.size() != 1 ? "s" : "") << " had duplicates, the duplicates will be removed:\n";
-			OutputMap(duplicatePLAYERs, this->infoSection.PLAYERrecord.entries, this->count > 1);
+			std::cout << "The following PLAYER" << (duplicatePLAYERs.kept.size() != 1 ? "s" : "") << " had duplicates, the duplicates will be removed:\n";
+			OutputMap(duplicatePLAYERs.kept, this->infoSection.PLAYERrecord.entries, this->count > 1);
 			std::cout << "\n";
 		}
 	}
@@ -859,34 +1205,39 @@ void SDAT::Strip(const IncOrExc &includesAndExcludes, bool verbose, bool removed
 	newInfoSection.PLAYERrecord.entryOffsets.resize(newInfoSection.PLAYERrecord.count);
 	newInfoSection.PLAYERrecord.entries.resize(newInfoSection.PLAYERrecord.count);
 
+	auto SSEQPositions = GetFilePositions(this->SSEQs);
+	auto SBNKPositions = GetFilePositions(this->SBNKs);
+	auto SWARPositions = GetFilePositions(this->SWARs);
+
 	SSEQList newSSEQs;
+	newSSEQs.reserve(SSEQsToKeep.size());
 	uint16_t fileID = 0;
 	for (size_t i = 0, num = SSEQsToKeep.size(); i < num; ++i)
 	{
 		if (this->SYMBOffset)
-			newSymbSection.SEQrecord.entries[i] = this->symbSection.SEQrecord.entries[SSEQsToKeep[i]];
+			newSymbSection.SEQrecord.entries[i] = std::move(this->symbSection.SEQrecord.entries[SSEQsToKeep[i]]);
 
 		auto &newSEQEntry = newInfoSection.SEQrecord.entries[i];
-		newSEQEntry = this->infoSection.SEQrecord.entries[SSEQsToKeep[i]];
+		newSEQEntry = std::move(this->infoSection.SEQrecord.entries[SSEQsToKeep[i]]);
 		newSEQEntry.fileID = fileID++;
 		uint16_t nonDupBank = GetNonDupNumber(newSEQEntry.bank, duplicateSBNKs);
 		newSEQEntry.bank = SBNKMove[nonDupBank];
 		uint16_t nonDupPlayer = GetNonDupNumber(newSEQEntry.ply, duplicatePLAYERs);
 		newSEQEntry.ply = PLAYERMove[nonDupPlayer];
-		auto sseq = this->GetNonConstSSEQ(newSEQEntry.sseq);
-		(*sseq)->entryNumber = i;
-		newSSEQs.push_back(std::move(*sseq));
-		this->SSEQs.erase(sseq);
+		auto &sseq = this->SSEQs[SSEQPositions.at(newSEQEntry.sseq)];
+		sseq->entryNumber = i;
+		newSSEQs.push_back(std::move(sseq));
 	}
 
 	SBNKList newSBNKs;
+	newSBNKs.reserve(SBNKsToKeep.size());
 	for (size_t i = 0, num = SBNKsToKeep.size(); i < num; ++i)
 	{
 		if (this->SYMBOffset)
-			newSymbSection.BANKrecord.entries[i] = this->symbSection.BANKrecord.entries[SBNKsToKeep[i]];
+			newSymbSection.BANKrecord.entries[i] = std::move(this->symbSection.BANKrecord.entries[SBNKsToKeep[i]]);
 
 		auto &newBANKEntry = newInfoSection.BANKrecord.entries[i];
-		newBANKEntry = this->infoSection.BANKrecord.entries[SBNKsToKeep[i]];
+		newBANKEntry = std::move(this->infoSection.BANKrecord.entries[SBNKsToKeep[i]]);
 		newBANKEntry.fileID = fileID++;
 		for (int j = 0; j < 4; ++j)
 		{
@@ -896,38 +1247,37 @@ void SDAT::Strip(const IncOrExc &includesAndExcludes, bool verbose, bool removed
 			uint16_t nonDupWaveArc = GetNonDupNumber(waveArc, duplicateSWARs);
 			newBANKEntry.waveArc[j] = SWARMove[nonDupWaveArc];
 		}
-		auto sbnk = this->GetNonConstSBNK(newBANKEntry.sbnk);
-		(*sbnk)->entryNumber = i;
-		newSBNKs.push_back(std::move(*sbnk));
-		this->SBNKs.erase(sbnk);
+		auto &sbnk = this->SBNKs[SBNKPositions.at(newBANKEntry.sbnk)];
+		sbnk->entryNumber = i;
+		newSBNKs.push_back(std::move(sbnk));
 	}
 
 	SWARList newSWARs;
+	newSWARs.reserve(SWARsToKeep.size());
 	for (size_t i = 0, num = SWARsToKeep.size(); i < num; ++i)
 	{
 		if (this->SYMBOffset)
-			newSymbSection.WAVEARCrecord.entries[i] = this->symbSection.WAVEARCrecord.entries[SWARsToKeep[i]];
+			newSymbSection.WAVEARCrecord.entries[i] = std::move(this->symbSection.WAVEARCrecord.entries[SWARsToKeep[i]]);
 
 		auto &newWAVEARCEntry = newInfoSection.WAVEARCrecord.entries[i];
-		newWAVEARCEntry = this->infoSection.WAVEARCrecord.entries[SWARsToKeep[i]];
+		newWAVEARCEntry = std::move(this->infoSection.WAVEARCrecord.entries[SWARsToKeep[i]]);
 		newWAVEARCEntry.fileID = fileID++;
-		auto swar = this->GetNonConstSWAR(newWAVEARCEntry.swar);
-		(*swar)->entryNumber = i;
-		newSWARs.push_back(std::move(*swar));
-		this->SWARs.erase(swar);
+		auto &swar = this->SWARs[SWARPositions.at(newWAVEARCEntry.swar)];
+		swar->entryNumber = i;
+		newSWARs.push_back(std::move(swar));
 	}
 
 	for (size_t i = 0, num = PLAYERsToKeep.size(); i < num; ++i)
 	{
 		if (this->SYMBOffset)
-			newSymbSection.PLAYERrecord.entries[i] = this->symbSection.PLAYERrecord.entries[PLAYERsToKeep[i]];
+			newSymbSection.PLAYERrecord.entries[i] = std::move(this->symbSection.PLAYERrecord.entries[PLAYERsToKeep[i]]);
 
-		newInfoSection.PLAYERrecord.entries[i] = this->infoSection.PLAYERrecord.entries[PLAYERsToKeep[i]];
+		newInfoSection.PLAYERrecord.entries[i] = std::move(this->infoSection.PLAYERrecord.entries[PLAYERsToKeep[i]]);
 	}
 
 	if (this->SYMBOffset)
-		this->symbSection = newSymbSection;
-	this->infoSection = newInfoSection;
+		this->symbSection = std::move(newSymbSection);
+	this->infoSection = std::move(newInfoSection);
 
 	this->SSEQs = std::move(newSSEQs);
 	this->SBNKs = std::move(newSBNKs);
@@ -938,7 +1288,7 @@ void SDAT::Strip(const IncOrExc &includesAndExcludes, bool verbose, bool removed
 	newFatSection.count = fileID;
 	newFatSection.records.resize(newFatSection.count);
 
-	this->fatSection = newFatSection;
+	this->fatSection = std::move(newFatSection);
 
 	// If one of the files that was merged into this one had no SYMB section, then we need to fill in some dummy data for those entries
 	if (this->symbSectionNeedsCleanup)
@@ -946,17 +1296,14 @@ void SDAT::Strip(const IncOrExc &includesAndExcludes, bool verbose, bool removed
 		for (uint32_t i = 0, num = SSEQsToKeep.size(); i < num; ++i)
 		{
 			auto &symbEntry = this->symbSection.SEQrecord.entries[i];
-			auto &infoEntry = this->infoSection.SEQrecord.entries[i];
-			fileID = infoEntry.fileID;
+			fileID = this->infoSection.SEQrecord.entries[i].fileID;
 			if (symbEntry.empty())
 				symbEntry = "SSEQ" + NumToHexString(fileID).substr(2);
-			auto sseq = this->GetNonConstSSEQ(infoEntry.sseq);
-			if (sseq != this->SSEQs.end())
-			{
-				(*sseq)->origFilename = symbEntry;
-				if (symbEntry.substr(0, 4) != "SSEQ")
-					(*sseq)->filename = NumToHexString(i).substr(6) + " - " + symbEntry;
-			}
+			// The kept SSEQs were moved into the same order as their entries
+			auto &sseq = this->SSEQs[i];
+			sseq->origFilename = symbEntry;
+			if (symbEntry.substr(0, 4) != "SSEQ")
+				sseq->filename = NumToHexString(i).substr(6) + " - " + symbEntry;
 		}
 		for (uint32_t i = 0, num = SBNKsToKeep.size(); i < num; ++i)
 		{
@@ -1002,6 +1349,13 @@ typedef std::map<uint16_t, std::map<uint16_t, uint16_t>> MoveMap;
 
 void SDAT::StripBanksAndWaveArcs()
 {
+	// The patches in use are found from the SSEQs, so they all have to be read
+	this->ReadFiles();
+
+	auto SSEQPositions = GetFilePositions(this->SSEQs);
+	auto SBNKPositions = GetFilePositions(this->SBNKs);
+	auto SWARPositions = GetFilePositions(this->SWARs);
+
 	// Get all the unique patches
 	IndexMap BankPatches;
 	std::map<uint32_t, std::vector<uint32_t>> PatchPositions;
@@ -1021,7 +1375,7 @@ void SDAT::StripBanksAndWaveArcs()
 	for (uint32_t i = 0; i < this->infoSection.BANKrecord.count; ++i)
 	{
 		auto &entry = this->infoSection.BANKrecord.entries[i];
-		auto sbnk = this->GetNonConstSBNK(entry.sbnk)->get();
+		auto sbnk = this->SBNKs[SBNKPositions.at(entry.sbnk)].get();
 
 		// Figure out where the new patch positions are going to be
 		// Also edit the SBNK so the empty spaces and unused patches are removed
@@ -1077,7 +1431,7 @@ void SDAT::StripBanksAndWaveArcs()
 	std::for_each(WaveArcs.begin(), WaveArcs.end(), [&](const IndexMap::value_type &WaveArc)
 	{
 		auto &entry = this->infoSection.WAVEARCrecord.entries[WaveArc.first];
-		auto swar = this->GetNonConstSWAR(entry.swar)->get();
+		auto swar = this->SWARs[SWARPositions.at(entry.swar)].get();
 
 		SWAR::SWAVs newWaves;
 		for (size_t i = 0, j = 0, waves = WaveArc.second.size(); i < waves; ++i)
@@ -1095,15 +1449,16 @@ void SDAT::StripBanksAndWaveArcs()
 		// Also replace the file data for the SWAR
 		PseudoWrite newFileData;
 		swar->header.fileSize = swar->Size();
+		newFileData.Reserve(swar->header.fileSize);
 		swar->Write(newFileData);
-		entry.fileData = newFileData.vector->data;
+		entry.fileData = std::move(newFileData.vector->data);
 	});
 
 	// Edit the SBNKs so they point at the new waveform positions
 	for (size_t i = 0; i < this->infoSection.BANKrecord.count; ++i)
 	{
 		auto &entry = this->infoSection.BANKrecord.entries[i];
-		auto sbnk = this->GetNonConstSBNK(entry.sbnk)->get();
+		auto sbnk = this->SBNKs[SBNKPositions.at(entry.sbnk)].get();
 		std::for_each(sbnk->instruments.begin(), sbnk->instruments.end(), [&](SBNKInstrument &patch)
 		{
 			std::for_each(patch.ranges.begin(), patch.ranges.end(), [&](SBNKInstrumentRange &range)
@@ -1121,8 +1476,9 @@ void SDAT::StripBanksAndWaveArcs()
 		// Also replace the file data for the SBNK
 		PseudoWrite newFileData;
 		sbnk->header.fileSize = sbnk->Size();
+		newFileData.Reserve(sbnk->header.fileSize);
 		sbnk->Write(newFileData);
-		entry.fileData = newFileData.vector->data;
+		entry.fileData = std::move(newFileData.vector->data);
 	}
 
 	// Edit the SSEQs so they point at the new patch positions
@@ -1135,13 +1491,12 @@ void SDAT::StripBanksAndWaveArcs()
 		if (!PatchMove.count(entry.bank))
 			continue;
 
-		auto sseq = this->GetNonConstSSEQ(entry.sseq)->get();
+		auto sseq = this->SSEQs[SSEQPositions.at(entry.sseq)].get();
 		auto &BankPatchMove = PatchMove[entry.bank];
 
-		PseudoReadFile file;
-		file.GetDataFromVector(sseq->data.begin(), sseq->data.end());
+		PseudoReadView file(sseq->data);
 
-		std::vector<uint8_t> newFileData = sseq->data;
+		std::vector<uint8_t> newFileData(sseq->data.begin(), sseq->data.end());
 
 		int offset = 0;
 		const auto &positions = PatchPositions[i];
@@ -1164,9 +1519,11 @@ void SDAT::StripBanksAndWaveArcs()
 			}
 		}
 
-		sseq->data = newFileData;
-		entry.fileData.erase(entry.fileData.begin() + 0x1C, entry.fileData.end());
-		entry.fileData.insert(entry.fileData.end(), newFileData.begin(), newFileData.end());
+		// The SSEQ's data is kept as the part of the new file after its header
+		std::vector<uint8_t> fileData(entry.fileData.begin(), entry.fileData.begin() + 0x1C);
+		fileData.insert(fileData.end(), newFileData.begin(), newFileData.end());
+		entry.fileData = std::move(fileData);
+		sseq->data = SharedBytes(entry.fileData, 0x1C, newFileData.size());
 	}
 
 	// Fix the offsets and sizes
@@ -1178,12 +1535,12 @@ void SDAT::FixOffsetsAndSizes()
 	this->INFOOffset = 0x40;
 	if (this->SYMBOffset)
 	{
-		this->SYMBSize = this->symbSection.size = this->symbSection.Size();
 		this->symbSection.FixOffsets();
+		this->SYMBSize = this->symbSection.size;
 		this->INFOOffset = this->SYMBOffset + ((this->SYMBSize + 3) & ~0x03);
 	}
-	this->INFOSize = this->infoSection.size = this->infoSection.Size();
 	this->infoSection.FixOffsets();
+	this->INFOSize = this->infoSection.size;
 	this->FATOffset = this->INFOOffset + this->INFOSize;
 	this->FATSize = this->fatSection.size = this->fatSection.Size();
 	this->FILEOffset = this->FATOffset + this->FATSize;
@@ -1219,26 +1576,35 @@ void SDAT::FixOffsetsAndSizes()
 	this->header.blocks = this->SYMBOffset ? 4 : 3;
 }
 
-SDAT::SSEQList::iterator SDAT::GetNonConstSSEQ(const SSEQ *sseq)
+// Reads a file that was skipped by SDAT::Read from the data in its entry.
+// Header errors were already checked for (or were to be ignored) when the SDAT
+// was read, so they are ignored here.
+template<typename T, typename U> static inline const T *GetFile(U &entry, T *U::*entryFile)
 {
-	return std::find_if(this->SSEQs.begin(), this->SSEQs.end(), [&](const SSEQList::value_type &thisSSEQ)
+	if (entry.fileNeedsRead)
 	{
-		return thisSSEQ.get() == sseq;
-	});
+		if (entry.*entryFile)
+			(entry.*entryFile)->Read(entry.fileData, false);
+		entry.fileNeedsRead = false;
+	}
+	return entry.*entryFile;
 }
 
-SDAT::SBNKList::iterator SDAT::GetNonConstSBNK(const SBNK *sbnk)
+const SBNK *SDAT::GetSBNK(uint32_t entryNumber)
 {
-	return std::find_if(this->SBNKs.begin(), this->SBNKs.end(), [&](const SBNKList::value_type &thisSBNK)
-	{
-		return thisSBNK.get() == sbnk;
-	});
+	return GetFile(this->infoSection.BANKrecord.entries[entryNumber], &INFOEntryBANK::sbnk);
 }
 
-SDAT::SWARList::iterator SDAT::GetNonConstSWAR(const SWAR *swar)
+const SWAR *SDAT::GetSWAR(uint32_t entryNumber)
 {
-	return std::find_if(this->SWARs.begin(), this->SWARs.end(), [&](const SWARList::value_type &thisSWAR)
-	{
-		return thisSWAR.get() == swar;
-	});
+	return GetFile(this->infoSection.WAVEARCrecord.entries[entryNumber], &INFOEntryWAVEARC::swar);
+}
+
+// Reads all the files that were skipped by SDAT::Read
+void SDAT::ReadFiles()
+{
+	for (uint32_t i = 0, num = this->infoSection.BANKrecord.entries.size(); i < num; ++i)
+		this->GetSBNK(i);
+	for (uint32_t i = 0, num = this->infoSection.WAVEARCrecord.entries.size(); i < num; ++i)
+		this->GetSWAR(i);
 }
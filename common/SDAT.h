@@ -1,7 +1,7 @@
 /*
  * SDAT - SDAT structure
  * By Naram Qashat (CyberBotX) [cyberbotx@cyberbotx.com]
- * Last modification on 2014-12-08
+ * Last modification on 2026-10-17
  *
  * Nintendo DS Nitro Composer (SDAT) Specification document found at
  * http://www.feshrine.net/hacking/doc/nds-sdat.html
@@ -24,8 +24,6 @@ struct SDAT
 	typedef std::vector<std::unique_ptr<SBNK>> SBNKList;
 	typedef std::vector<std::unique_ptr<SWAR>> SWARList;
 
-	static bool failOnMissingFiles;
-
 	std::string filename;
 	NDSStdHeader header;
 	uint32_t SYMBOffset;
@@ -50,19 +48,27 @@ struct SDAT
 
 	SDAT();
 	SDAT(const SDAT &sdat);
+	SDAT(SDAT &&sdat);
 	SDAT &operator=(const SDAT &sdat);
+	SDAT &operator=(SDAT &&sdat);
 
-	void Read(const std::string &fn, PseudoReadFile &file, bool shouldFailOnMissingFiles = true);
+	static std::vector<uint32_t> FindSDATs(const PseudoReadView &file);
+	void Read(const std::string &fn, PseudoReadView &file, bool failOnMissingFiles = true, bool readFiles = true, size_t maxThreads = 0);
 	void Write(PseudoWrite &file) const;
 
 	SDAT MakeFromSSEQ(uint16_t SSEQNumber) const;
 
 	SDAT &operator+=(const SDAT &other);
+	SDAT &operator+=(SDAT &&other);
+	void Merge(std::vector<SDAT> &&sdats);
+	void AppendEntries(const SDAT &other);
+	void CopyFiles(const SDAT &other, uint32_t firstSEQ, uint32_t firstBANK, uint32_t firstWAVEARC);
+	void MoveFiles(SDAT &other, uint32_t firstSEQ, uint32_t firstBANK, uint32_t firstWAVEARC);
 	void Strip(const IncOrExc &includesAndExcludes, bool verbose, bool removeExcluded = true);
 	void StripBanksAndWaveArcs();
 	void FixOffsetsAndSizes();
 
-	SSEQList::iterator GetNonConstSSEQ(const SSEQ *sseq);
-	SBNKList::iterator GetNonConstSBNK(const SBNK *sbnk);
-	SWARList::iterator GetNonConstSWAR(const SWAR *swar);
+	const SBNK *GetSBNK(uint32_t entryNumber);
+	const SWAR *GetSWAR(uint32_t entryNumber);
+	void ReadFiles();
 };
@@ -1,7 +1,7 @@
 /*
  * SDAT - SSEQ (Sequence) structure
  * By Naram Qashat (CyberBotX) [cyberbotx@cyberbotx.com]
- * Last modification on 2014-12-08
+ * Last modification on 2026-10-17
  *
  * Nintendo DS Nitro Composer (SDAT) Specification document found at
  * http://www.feshrine.net/hacking/doc/nds-sdat.html
@@ -15,9 +15,10 @@ SSEQ::SSEQ(const std::string &fn, const std::string &origFn) : filename(fn), ori
 {
 }
 
-void SSEQ::Read(PseudoReadFile &file)
+// The SSEQ's data only refers to its part of the given data, see SharedBytes
+void SSEQ::Read(const SharedBytes &sseqData, bool failOnMissingFiles)
 {
-	uint32_t startOfSSEQ = file.pos;
+	PseudoReadView file(sseqData);
 	NDSStdHeader header;
 	header.Read(file);
 	try
@@ -26,7 +27,7 @@ void SSEQ::Read(PseudoReadFile &file)
 	}
 	catch (const std::exception &)
 	{
-		if (SDAT::failOnMissingFiles)
+		if (failOnMissingFiles)
 			throw;
 		else
 			return;
@@ -37,7 +38,5 @@ void SSEQ::Read(PseudoReadFile &file)
 		throw std::runtime_error("SSEQ DATA structure invalid");
 	uint32_t size = file.ReadLE<uint32_t>();
 	uint32_t dataOffset = file.ReadLE<uint32_t>();
-	this->data.resize(size - 12, 0);
-	file.pos = startOfSSEQ + dataOffset;
-	file.ReadLE(this->data);
+	this->data = SharedBytes(sseqData, dataOffset, size - 12);
 }
@@ -1,7 +1,7 @@
 /*
  * SDAT - SSEQ (Sequence) structure
  * By Naram Qashat (CyberBotX) [cyberbotx@cyberbotx.com]
- * Last modification on 2014-12-08
+ * Last modification on 2026-10-17
  *
  * Nintendo DS Nitro Composer (SDAT) Specification document found at
  * http://www.feshrine.net/hacking/doc/nds-sdat.html
@@ -15,11 +15,11 @@
 struct SSEQ
 {
 	std::string filename, origFilename;
-	std::vector<uint8_t> data;
+	SharedBytes data;
 
 	int32_t entryNumber;
 
 	SSEQ(const std::string &fn = "", const std::string &origFn = "");
 
-	void Read(PseudoReadFile &file);
+	void Read(const SharedBytes &sseqData, bool failOnMissingFiles);
 };
@@ -1,7 +1,7 @@
 /*
  * SSEQ Player - SDAT SWAR (Wave Archive) structures
  * By Naram Qashat (CyberBotX)
- * Last modification on 2014-12-08
+ * Last modification on 2026-10-17
  *
  * Nintendo DS Nitro Composer (SDAT) Specification document found at
  * http://www.feshrine.net/hacking/doc/nds-sdat.html
@@ -14,12 +14,12 @@ SWAR::SWAR(const std::string &fn) : filename(fn), header(), swavs(), entryNumber
 {
 }
 
-SWAR::SWAR(const SWAR &swar) : filename(swar.filename), header(swar.header), swavs(), entryNumber(swar.entryNumber)
+SWAR::SWAR(const SWAR &swar) : filename(swar.filename), header(swar.header), swavs(swar.swavs), entryNumber(swar.entryNumber)
+{
+}
+
+SWAR::SWAR(SWAR &&swar) : filename(std::move(swar.filename)), header(swar.header), swavs(std::move(swar.swavs)), entryNumber(swar.entryNumber)
 {
-	std::for_each(swar.swavs.begin(), swar.swavs.end(), [&](const SWAVs::value_type &swav)
-	{
-		this->swavs[swav.first].reset(new SWAV(*swav.second.get()));
-	});
 }
 
 SWAR &SWAR::operator=(const SWAR &swar)
@@ -28,18 +28,28 @@ SWAR &SWAR::operator=(const SWAR &swar)
 	{
 		this->filename = swar.filename;
 		this->header = swar.header;
-		std::for_each(swar.swavs.begin(), swar.swavs.end(), [&](const SWAVs::value_type &swav)
-		{
-			this->swavs[swav.first].reset(new SWAV(*swav.second.get()));
-		});
+		this->swavs = swar.swavs;
+		this->entryNumber = swar.entryNumber;
+	}
+	return *this;
+}
 
+SWAR &SWAR::operator=(SWAR &&swar)
+{
+	if (this != &swar)
+	{
+		this->filename = std::move(swar.filename);
+		this->header = swar.header;
+		this->swavs = std::move(swar.swavs);
 		this->entryNumber = swar.entryNumber;
 	}
 	return *this;
 }
 
-void SWAR::Read(PseudoReadFile &file)
+// The SWAVs' data only refers to their parts of the given data, see SharedBytes
+void SWAR::Read(const SharedBytes &swarData, bool failOnMissingFiles)
 {
+	PseudoReadView file(swarData);
 	uint32_t startOfSWAR = file.pos;
 	this->header.Read(file);
 	try
@@ -48,7 +58,7 @@ void SWAR::Read(PseudoReadFile &file)
 	}
 	catch (const std::exception &)
 	{
-		if (SDAT::failOnMissingFiles)
+		if (failOnMissingFiles)
 			throw;
 		else
 			return;
@@ -66,9 +76,9 @@ void SWAR::Read(PseudoReadFile &file)
 	for (uint32_t i = 0; i < count; ++i)
 		if (offsets[i])
 		{
-			file.pos = startOfSWAR + offsets[i];
-			this->swavs[i].reset(new SWAV());
-			this->swavs[i]->Read(file);
+			auto swav = std::make_shared<SWAV>();
+			swav->Read(swarData, startOfSWAR + offsets[i]);
+			this->swavs[i] = swav;
 		}
 }
 
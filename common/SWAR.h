@@ -1,7 +1,7 @@
 /*
  * SDAT - SWAR (Wave Archive) structures
  * By Naram Qashat (CyberBotX)
- * Last modification on 2014-12-08
+ * Last modification on 2026-10-17
  *
  * Nintendo DS Nitro Composer (SDAT) Specification document found at
  * http://www.feshrine.net/hacking/doc/nds-sdat.html
@@ -17,7 +17,8 @@
 
 struct SWAR
 {
-	typedef std::map<uint32_t, std::unique_ptr<SWAV>> SWAVs;
+	// The SWAVs are never modified once read, so copies of the SWAR share them
+	typedef std::map<uint32_t, std::shared_ptr<const SWAV>> SWAVs;
 
 	std::string filename;
 	NDSStdHeader header;
@@ -27,9 +28,11 @@ struct SWAR
 
 	SWAR(const std::string &fn = "");
 	SWAR(const SWAR &swar);
+	SWAR(SWAR &&swar);
 	SWAR &operator=(const SWAR &swar);
+	SWAR &operator=(SWAR &&swar);
 
-	void Read(PseudoReadFile &file);
+	void Read(const SharedBytes &swarData, bool failOnMissingFiles);
 	uint32_t Size() const;
 	void Write(PseudoWrite &file) const;
 };
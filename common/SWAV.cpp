@@ -1,7 +1,7 @@
 /*
  * SDAT - SWAV (Waveform/Sample) structure
  * By Naram Qashat (CyberBotX)
- * Last modification on 2014-12-08
+ * Last modification on 2026-10-17
  *
  * Nintendo DS Nitro Composer (SDAT) Specification document found at
  * http://www.feshrine.net/hacking/doc/nds-sdat.html
@@ -62,7 +62,7 @@ static inline void DecodeADPCMNibble(int32_t nibble, int32_t &stepIndex, int32_t
 		predictedValue = 0x7FFF;
 }
 
-void SWAV::DecodeADPCM(uint32_t len)
+void SWAV::DecodeADPCM(uint32_t len) const
 {
 	int32_t predictedValue = this->origData[0] | (this->origData[1] << 8);
 	int32_t stepIndex = this->origData[2] | (this->origData[3] << 8);
@@ -80,46 +80,67 @@ void SWAV::DecodeADPCM(uint32_t len)
 	}
 }
 
-void SWAV::Read(PseudoReadFile &file)
+// Reads the SWAV from the given offset within its SWAR's data, the original
+// data only refers to its part of the SWAR's data
+void SWAV::Read(const SharedBytes &swarData, uint32_t offset)
 {
-	this->waveType = file.ReadLE<uint8_t>();
-	this->loop = file.ReadLE<uint8_t>();
-	this->sampleRate = file.ReadLE<uint16_t>();
-	this->time = file.ReadLE<uint16_t>();
-	this->loopOffset = this->origLoopOffset = file.ReadLE<uint16_t>();
-	this->nonLoopLength = this->origNonLoopLength = file.ReadLE<uint32_t>();
+	PseudoReadView file(swarData);
+	file.pos = offset;
+	auto header = file.GetCursor(12);
+	this->waveType = header.ReadLE<uint8_t>();
+	this->loop = header.ReadLE<uint8_t>();
+	this->sampleRate = header.ReadLE<uint16_t>();
+	this->time = header.ReadLE<uint16_t>();
+	this->loopOffset = this->origLoopOffset = header.ReadLE<uint16_t>();
+	this->nonLoopLength = this->origNonLoopLength = header.ReadLE<uint32_t>();
 	uint32_t size = (this->loopOffset + this->nonLoopLength) * 4;
-	this->origData.resize(size);
-	file.ReadLE(this->origData);
+	this->origData = SharedBytes(swarData, offset + 12, size);
 
-	// Convert data accordingly
+	// Convert the loop offset and length from words to samples
+	if (!this->waveType)
+	{
+		this->loopOffset *= 4;
+		this->nonLoopLength *= 4;
+	}
+	else if (this->waveType == 1)
+	{
+		this->loopOffset *= 2;
+		this->nonLoopLength *= 2;
+	}
+	else if (this->waveType == 2)
+	{
+		if (this->loopOffset)
+			--this->loopOffset;
+		this->loopOffset *= 8;
+		this->nonLoopLength *= 8;
+	}
+}
+
+// Converts the original data to signed 16-bit PCM, if it hasn't been already
+void SWAV::Decode() const
+{
+	if (!this->data.empty())
+		return;
+
+	uint32_t size = this->origData.size();
 	if (!this->waveType)
 	{
 		// PCM 8-bit -> PCM signed 16-bit
 		this->data.resize(size, 0);
 		for (size_t i = 0; i < size; ++i)
 			this->data[i] = this->origData[i] << 8;
-		this->loopOffset *= 4;
-		this->nonLoopLength *= 4;
 	}
 	else if (this->waveType == 1)
 	{
 		// PCM signed 16-bit, no conversion
 		this->data.resize(size / 2, 0);
-		for (size_t i = 0; i < size / 2; ++i)
-			this->data[i] = ReadLE<int16_t>(&this->origData[2 * i]);
-		this->loopOffset *= 2;
-		this->nonLoopLength *= 2;
+		PseudoReadView(this->origData).GetCursor(size).ReadLE(this->data);
 	}
 	else if (this->waveType == 2)
 	{
 		// IMA ADPCM -> PCM signed 16-bit
 		this->data.resize((size - 4) * 2, 0);
 		this->DecodeADPCM(size - 4);
-		if (this->loopOffset)
-			--this->loopOffset;
-		this->loopOffset *= 8;
-		this->nonLoopLength *= 8;
 	}
 }
 
@@ -1,7 +1,7 @@
 /*
  * SDAT - SWAV (Waveform/Sample) structure
  * By Naram Qashat (CyberBotX)
- * Last modification on 2014-12-08
+ * Last modification on 2026-10-17
  *
  * Nintendo DS Nitro Composer (SDAT) Specification document found at
  * http://www.feshrine.net/hacking/doc/nds-sdat.html
@@ -21,13 +21,16 @@ struct SWAV
 	uint32_t loopOffset;
 	uint32_t origNonLoopLength;
 	uint32_t nonLoopLength;
-	std::vector<uint8_t> origData;
-	std::vector<int16_t> data;
+	SharedBytes origData;
+	// The decoded samples are only needed for playing notes, so they are left
+	// empty until Decode is called and then kept for later notes
+	mutable std::vector<int16_t> data;
 
 	SWAV();
 
-	void Read(PseudoReadFile &file);
-	void DecodeADPCM(uint32_t len);
+	void Read(const SharedBytes &swarData, uint32_t offset);
+	void Decode() const;
+	void DecodeADPCM(uint32_t len) const;
 	uint32_t Size() const;
 	void Write(PseudoWrite &file) const;
 };
@@ -1,7 +1,7 @@
 /*
  * SDAT - SYMB (Symbol/Filename) Section structures
  * By Naram Qashat (CyberBotX) [cyberbotx@cyberbotx.com]
- * Last modification on 2014-10-25
+ * Last modification on 2026-10-17
  *
  * Nintendo DS Nitro Composer (SDAT) Specification document found at
  * http://www.feshrine.net/hacking/doc/nds-sdat.html
@@ -13,7 +13,39 @@ SYMBRecord::SYMBRecord() : count(0), entryOffsets(), entries()
 {
 }
 
-void SYMBRecord::Read(PseudoReadFile &file, uint32_t startOffset)
+SYMBRecord::SYMBRecord(const SYMBRecord &record) : count(record.count), entryOffsets(record.entryOffsets), entries(record.entries)
+{
+}
+
+SYMBRecord::SYMBRecord(SYMBRecord &&record) : count(record.count), entryOffsets(std::move(record.entryOffsets)), entries(std::move(record.entries))
+{
+	record.count = 0;
+}
+
+SYMBRecord &SYMBRecord::operator=(const SYMBRecord &record)
+{
+	if (this != &record)
+	{
+		this->count = record.count;
+		this->entryOffsets = record.entryOffsets;
+		this->entries = record.entries;
+	}
+	return *this;
+}
+
+SYMBRecord &SYMBRecord::operator=(SYMBRecord &&record)
+{
+	if (this != &record)
+	{
+		this->count = record.count;
+		this->entryOffsets = std::move(record.entryOffsets);
+		this->entries = std::move(record.entries);
+		record.count = 0;
+	}
+	return *this;
+}
+
+void SYMBRecord::Read(PseudoReadView &file, uint32_t startOffset)
 {
 	this->count = file.ReadLE<uint32_t>();
 	this->entryOffsets.resize(this->count);
@@ -35,7 +67,7 @@ uint32_t SYMBRecord::Size() const
 	return recordSize;
 }
 
-void SYMBRecord::FixOffsets(uint32_t startOffset)
+uint32_t SYMBRecord::FixOffsets(uint32_t startOffset)
 {
 	uint32_t offset = startOffset;
 	for (uint32_t i = 0; i < this->count; ++i)
@@ -43,6 +75,7 @@ void SYMBRecord::FixOffsets(uint32_t startOffset)
 		this->entryOffsets[i] = offset;
 		offset += this->entries[i].size() + 1;
 	}
+	return offset;
 }
 
 void SYMBRecord::WriteHeader(PseudoWrite &file) const
@@ -63,7 +96,51 @@ SYMBSection::SYMBSection() : size(0), SEQrecord(), BANKrecord(), WAVEARCrecord()
 	memset(this->recordOffsets, 0, sizeof(this->recordOffsets));
 }
 
-void SYMBSection::Read(PseudoReadFile &file)
+SYMBSection::SYMBSection(const SYMBSection &symb) : size(symb.size), SEQrecord(symb.SEQrecord), BANKrecord(symb.BANKrecord), WAVEARCrecord(symb.WAVEARCrecord),
+	PLAYERrecord(symb.PLAYERrecord)
+{
+	memcpy(this->type, symb.type, sizeof(this->type));
+	memcpy(this->recordOffsets, symb.recordOffsets, sizeof(this->recordOffsets));
+}
+
+SYMBSection::SYMBSection(SYMBSection &&symb) : size(symb.size), SEQrecord(std::move(symb.SEQrecord)), BANKrecord(std::move(symb.BANKrecord)),
+	WAVEARCrecord(std::move(symb.WAVEARCrecord)), PLAYERrecord(std::move(symb.PLAYERrecord))
+{
+	memcpy(this->type, symb.type, sizeof(this->type));
+	memcpy(this->recordOffsets, symb.recordOffsets, sizeof(this->recordOffsets));
+}
+
+SYMBSection &SYMBSection::operator=(const SYMBSection &symb)
+{
+	if (this != &symb)
+	{
+		memcpy(this->type, symb.type, sizeof(this->type));
+		this->size = symb.size;
+		memcpy(this->recordOffsets, symb.recordOffsets, sizeof(this->recordOffsets));
+		this->SEQrecord = symb.SEQrecord;
+		this->BANKrecord = symb.BANKrecord;
+		this->WAVEARCrecord = symb.WAVEARCrecord;
+		this->PLAYERrecord = symb.PLAYERrecord;
+	}
+	return *this;
+}
+
+SYMBSection &SYMBSection::operator=(SYMBSection &&symb)
+{
+	if (this != &symb)
+	{
+		memcpy(this->type, symb.type, sizeof(this->type));
+		this->size = symb.size;
+		memcpy(this->recordOffsets, symb.recordOffsets, sizeof(this->recordOffsets));
+		this->SEQrecord = std::move(symb.SEQrecord);
+		this->BANKrecord = std::move(symb.BANKrecord);
+		this->WAVEARCrecord = std::move(symb.WAVEARCrecord);
+		this->PLAYERrecord = std::move(symb.PLAYERrecord);
+	}
+	return *this;
+}
+
+void SYMBSection::Read(PseudoReadView &file)
 {
 	uint32_t startOfSYMB = file.pos;
 	file.ReadLE(this->type);
@@ -114,13 +191,11 @@ void SYMBSection::FixOffsets()
 	this->recordOffsets[REC_PLAYER2] = this->recordOffsets[REC_GROUP] + 4;
 	this->recordOffsets[REC_STRM] = this->recordOffsets[REC_PLAYER2] + 4;
 	uint32_t offset = this->recordOffsets[REC_STRM] + 4;
-	this->SEQrecord.FixOffsets(offset);
-	offset += this->SEQrecord.Size() - 4 - 4 * this->SEQrecord.count;
-	this->BANKrecord.FixOffsets(offset);
-	offset += this->BANKrecord.Size() - 4 - 4 * this->BANKrecord.count;
-	this->WAVEARCrecord.FixOffsets(offset);
-	offset += this->WAVEARCrecord.Size() - 4 - 4 * this->WAVEARCrecord.count;
-	this->PLAYERrecord.FixOffsets(offset);
+	offset = this->SEQrecord.FixOffsets(offset);
+	offset = this->BANKrecord.FixOffsets(offset);
+	offset = this->WAVEARCrecord.FixOffsets(offset);
+	// The entries are the last thing in the section, so the end of them is also the size of the section
+	this->size = this->PLAYERrecord.FixOffsets(offset);
 }
 
 void SYMBSection::Write(PseudoWrite &file) const
@@ -1,7 +1,7 @@
 /*
  * SDAT - SYMB (Symbol/Filename) Section structures
  * By Naram Qashat (CyberBotX) [cyberbotx@cyberbotx.com]
- * Last modification on 2014-10-25
+ * Last modification on 2026-10-17
  *
  * Nintendo DS Nitro Composer (SDAT) Specification document found at
  * http://www.feshrine.net/hacking/doc/nds-sdat.html
@@ -18,10 +18,14 @@ struct SYMBRecord
 	std::vector<std::string> entries;
 
 	SYMBRecord();
+	SYMBRecord(const SYMBRecord &record);
+	SYMBRecord(SYMBRecord &&record);
+	SYMBRecord &operator=(const SYMBRecord &record);
+	SYMBRecord &operator=(SYMBRecord &&record);
 
-	void Read(PseudoReadFile &file, uint32_t startOffset);
+	void Read(PseudoReadView &file, uint32_t startOffset);
 	uint32_t Size() const;
-	void FixOffsets(uint32_t startOffset);
+	uint32_t FixOffsets(uint32_t startOffset);
 	void WriteHeader(PseudoWrite &file) const;
 	void WriteData(PseudoWrite &file) const;
 };
@@ -37,8 +41,12 @@ struct SYMBSection
 	SYMBRecord PLAYERrecord;
 
 	SYMBSection();
+	SYMBSection(const SYMBSection &symb);
+	SYMBSection(SYMBSection &&symb);
+	SYMBSection &operator=(const SYMBSection &symb);
+	SYMBSection &operator=(SYMBSection &&symb);
 
-	void Read(PseudoReadFile &file);
+	void Read(PseudoReadView &file);
 	uint32_t Size() const;
 	void FixOffsets();
 	void Write(PseudoWrite &file) const;
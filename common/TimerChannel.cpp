@@ -1,7 +1,7 @@
 /*
  * SDAT - Timer Channel structure
  * By Naram Qashat (CyberBotX) [cyberbotx@cyberbotx.com]
- * Last modification on 2014-10-23
+ * Last modification on 2026-10-17
  *
  * Adapted from source code of FeOS Sound System
  * By fincs
@@ -41,7 +41,7 @@ static inline int Cnv_Sine(int arg)
 }
 
 NDSSoundRegister::NDSSoundRegister() : volumeMul(0), volumeDiv(0), panning(0), waveDuty(0), repeatMode(0), format(0), enable(false),
-	source(nullptr), timer(0), psgX(0), psgLast(0), psgLastCount(0), samplePosition(0), sampleIncrease(0), loopStart(0), length(0)
+	source(nullptr), timer(0), psgX(0), psgLast(0), psgLastCount(0), samplePosition(0), sampleIncrease(0), loopStart(0), length(0), totalLength(0)
 {
 }
 
@@ -547,7 +547,9 @@ void TimerChannel::Update()
 		if (totalAdj)
 			tmr = Timer_Adjust(tmr, totalAdj);
 		this->reg.timer = -tmr;
-		this->reg.sampleIncrease = 87296.0 / (0x10000 - this->reg.timer);
+		// The timer counts up 64 * 2728 / 2 times in each tick, rounding up so a position that lands on a sample exactly reaches it
+		uint32_t timerPeriod = 0x10000 - this->reg.timer;
+		this->reg.sampleIncrease = static_cast<int64_t>(((UINT64_C(87296) << SAMPLE_POSITION_SHIFT) + timerPeriod - 1) / timerPeriod);
 		this->flags.reset(CF_UPDTMR);
 	}
 
@@ -615,20 +617,20 @@ int32_t TimerChannel::GenerateSample()
 	if (this->reg.samplePosition < 0)
 		return 0;
 
+	uint32_t pos = static_cast<uint32_t>(this->reg.samplePosition >> SAMPLE_POSITION_SHIFT);
 	if (this->reg.format != 3)
-		return this->reg.source->data[static_cast<uint32_t>(this->reg.samplePosition)];
+		return this->reg.source->data[pos];
 	else
 	{
 		if (this->chnId < 8)
 			return 0;
 		else if (this->chnId < 14)
-			return wavedutytbl[this->reg.waveDuty][static_cast<uint32_t>(this->reg.samplePosition) & 0x7];
+			return wavedutytbl[this->reg.waveDuty][pos & 0x7];
 		else
 		{
-			if (this->reg.psgLastCount != static_cast<uint32_t>(this->reg.samplePosition))
+			if (this->reg.psgLastCount != pos)
 			{
-				uint32_t max = static_cast<uint32_t>(this->reg.samplePosition);
-				for (uint32_t i = this->reg.psgLastCount; i < max; ++i)
+				for (uint32_t i = this->reg.psgLastCount; i < pos; ++i)
 				{
 					if (this->reg.psgX & 0x1)
 					{
@@ -642,7 +644,7 @@ int32_t TimerChannel::GenerateSample()
 					}
 				}
 
-				this->reg.psgLastCount = static_cast<uint32_t>(this->reg.samplePosition);
+				this->reg.psgLastCount = pos;
 			}
 
 			return this->reg.psgLast;
@@ -653,12 +655,13 @@ int32_t TimerChannel::GenerateSample()
 void TimerChannel::IncrementSample()
 {
 	this->reg.samplePosition += this->reg.sampleIncrease;
-	if (this->reg.format != 3 && this->reg.samplePosition >= this->reg.totalLength)
+	if (this->reg.format != 3 && (this->reg.samplePosition >> SAMPLE_POSITION_SHIFT) >= this->reg.totalLength)
 	{
-		if (this->reg.repeatMode == 1)
+		// A loop with no length can't be repeated, so it is treated as a one-shot sample
+		if (this->reg.repeatMode == 1 && this->reg.length)
 		{
-			while (this->reg.samplePosition >= this->reg.totalLength)
-				this->reg.samplePosition -= this->reg.length;
+			int64_t loopStart = static_cast<int64_t>(this->reg.loopStart) << SAMPLE_POSITION_SHIFT;
+			this->reg.samplePosition = loopStart + (this->reg.samplePosition - loopStart) % (static_cast<int64_t>(this->reg.length) << SAMPLE_POSITION_SHIFT);
 		}
 		else
 			this->Kill();
@@ -1,7 +1,7 @@
 /*
  * SDAT - Timer Channel structure
  * By Naram Qashat (CyberBotX) [cyberbotx@cyberbotx.com]
- * Last modification on 2014-10-15
+ * Last modification on 2026-10-17
  *
  * Adapted from source code of FeOS Sound System
  * By fincs
@@ -52,6 +52,9 @@ enum { CF_UPDVOL, CF_UPDPAN, CF_UPDTMR, CF_BITS };
 
 const uint32_t ARM7_CLOCK = 33513982;
 
+// Sample positions are kept in 32.32 fixed-point
+const int SAMPLE_POSITION_SHIFT = 32;
+
 inline int SOUND_FREQ(int n) { return -0x1000000 / n; }
 
 inline uint32_t SOUND_VOL(int n) { return n; }
@@ -93,9 +96,9 @@ struct NDSSoundRegister
 	int16_t psgLast;
 	uint32_t psgLastCount;
 
-	// The following are taken from DeSmuME
-	double samplePosition;
-	double sampleIncrease;
+	// The following are taken from DeSmuME, but in fixed-point instead of floating-point
+	int64_t samplePosition;
+	int64_t sampleIncrease;
 
 	// Loopstart Register
 	uint32_t loopStart;
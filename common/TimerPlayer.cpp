@@ -1,7 +1,7 @@
 /*
  * SDAT - Timer Player structure
  * By Naram Qashat (CyberBotX) [cyberbotx@cyberbotx.com]
- * Last modification on 2014-12-08
+ * Last modification on 2026-10-17
  *
  * Adapted from source code of FeOS Sound System
  * By fincs
@@ -10,20 +10,43 @@
  * This has been modified in order to be able to provide timing for an SSEQ.
  */
 
+#include <limits>
 #include "TimerPlayer.h"
 
 #undef min
 #undef max
 
+#ifndef _WIN32
+// The deadline for the length is kept on the monotonic clock where it can be,
+// so changes to the system time don't affect it
+# ifdef __APPLE__
+static const clockid_t FinishedClock = CLOCK_REALTIME;
+# else
+static const clockid_t FinishedClock = CLOCK_MONOTONIC;
+# endif
+#endif
+
 TimerPlayer::TimerPlayer() : prio(0), nTracks(0), tempo(120), tempoCount(0), tempoRate(0x100), masterVol(0), sseqVol(0), trailingSilenceSeconds(0), sseq(nullptr), sbnk(nullptr),
-	seconds(0),
+	seconds(0), stepCount(0),
 #ifdef _WIN32
-	mutex(CreateMutex(nullptr, false, nullptr)), thread(nullptr),
+	thread(nullptr),
 #else
-	mutex(PTHREAD_MUTEX_INITIALIZER), thread(0),
+	thread(0), finishedMutex(), finishedCondition(), finished(false),
 #endif
-	maxSeconds(0), loops(0), doLength(false), doNotes(false), length()
+	maxSeconds(0), loops(0), doLength(false), doNotes(false), length(), program(), exactLoops(false), introLength(0),
+	loopLength(0), states(), currentState(), stateOffsets(1, 0), stateSeconds(), stateSteps(), stateTempoCounts(), stateIndexes(), loopStartStep(0),
+	loopSteps(0), nextLoopStep(0), loopRepeats()
 {
+#ifndef _WIN32
+	pthread_mutex_init(&this->finishedMutex, nullptr);
+	pthread_condattr_t conditionAttributes;
+	pthread_condattr_init(&conditionAttributes);
+# ifndef __APPLE__
+	pthread_condattr_setclock(&conditionAttributes, FinishedClock);
+# endif
+	pthread_cond_init(&this->finishedCondition, &conditionAttributes);
+	pthread_condattr_destroy(&conditionAttributes);
+#endif
 	memset(this->swar, 0, sizeof(this->swar));
 	for (int i = 0; i < 16; ++i)
 	{
@@ -33,20 +56,31 @@ TimerPlayer::TimerPlayer() : prio(0), nTracks(0), tempo(120), tempoCount(0), tem
 	memset(this->variables, -1, sizeof(this->variables));
 }
 
+TimerPlayer::~TimerPlayer()
+{
+#ifdef _WIN32
+	if (this->thread)
+		CloseHandle(this->thread);
+#else
+	pthread_cond_destroy(&this->finishedCondition);
+	pthread_mutex_destroy(&this->finishedMutex);
+#endif
+}
+
 // Original FSS Function: Player_Setup
-void TimerPlayer::Setup(const SSEQ *sseqToPlay, const std::string &filename)
+void TimerPlayer::Setup(const SSEQ *sseqToPlay, const std::shared_ptr<const TimerProgram> &sseqProgram)
 {
 	this->sseq = sseqToPlay;
 
-	PseudoReadFile file(filename);
-	file.GetDataFromVector(this->sseq->data.begin(), this->sseq->data.end());
+	// The SSEQ is only decoded if it wasn't already, such as for an earlier player
+	if (sseqProgram)
+		this->program = sseqProgram;
+	else
+		this->program = std::make_shared<TimerProgram>(this->sseq->data);
 
-	this->tracks[0].Init(0, this, file);
+	this->tracks[0].Init(0, this, this->program.get(), this->program->start);
 
 	this->nTracks = 1;
-
-	this->tracks[0].file = file;
-	this->tracks[0].startPos = file.pos;
 }
 
 // Original FSS Function: Chn_Alloc
@@ -85,6 +119,8 @@ int TimerPlayer::ChannelAlloc(int type, int priority)
 }
 
 const double SecondsPerClockCycle = 64.0 * 2728.0 / ARM7_CLOCK;
+// How long the silence after a one-shot song has to be for it to have ended
+const double SecondsOfSilenceAtEnd = 20.0;
 
 // Original FSS Function: Player_Run
 void TimerPlayer::Run()
@@ -92,6 +128,7 @@ void TimerPlayer::Run()
 	while (this->tempoCount > 240)
 	{
 		this->tempoCount -= 240;
+		++this->stepCount;
 		for (uint8_t i = 0; i < this->nTracks; ++i)
 		{
 			this->tracks[i].Run();
@@ -121,6 +158,77 @@ void TimerPlayer::UpdateTracks()
 		this->tracks[i].updateFlags.reset();
 }
 
+// When the notes aren't being played, or none of the channels are playing
+// one, the ticks before a track next runs any commands only change the tempo
+// count, each track's wait and the time (and the trailing silence, as
+// nothing can be heard), so those ticks are skipped over here, leaving Run to
+// do the tick where a track's wait runs out.  The time is still added to once
+// per tick so that it comes out exactly the same as running each of those
+// ticks.  The tick that makes the trailing silence long enough is also left
+// to be run, so the length is found the same way as without skipping.
+// Returns false if finding the length was cancelled or the time went past
+// stopSeconds while skipping.
+bool TimerPlayer::FastForward(double stopSeconds)
+{
+	// A track runs commands on the step its wait runs out, or the very next
+	// step if it has no wait, while ended tracks and tracks with a negative
+	// wait never will again
+	int64_t nextStep = std::numeric_limits<int64_t>::max();
+	for (uint8_t i = 0; i < this->nTracks; ++i)
+	{
+		const TimerTrack &track = this->tracks[i];
+		if (!track.state[TS_END] && track.wait >= 0)
+			nextStep = std::min<int64_t>(nextStep, track.wait ? track.wait : 1);
+	}
+
+	int increment = (static_cast<int>(this->tempo) * static_cast<int>(this->tempoRate)) >> 8;
+	uint16_t currentTempoCount = this->tempoCount;
+	double currentSeconds = this->seconds, currentSilence = this->trailingSilenceSeconds;
+	int64_t steps = 0;
+	bool keepGoing = true;
+	for (;;)
+	{
+		int64_t tickSteps = 0;
+		uint16_t count = currentTempoCount;
+		while (count > 240)
+		{
+			count -= 240;
+			++tickSteps;
+		}
+		if (steps + tickSteps >= nextStep)
+			break;
+		double nextSilence = currentSilence + SecondsPerClockCycle;
+		if (this->doNotes && nextSilence >= SecondsOfSilenceAtEnd)
+			break;
+		if (!this->IsDoingLength())
+		{
+			keepGoing = false;
+			break;
+		}
+		steps += tickSteps;
+		count += increment;
+		currentTempoCount = count;
+		currentSilence = nextSilence;
+		currentSeconds += SecondsPerClockCycle;
+		if (currentSeconds > stopSeconds)
+		{
+			keepGoing = false;
+			break;
+		}
+	}
+
+	this->tempoCount = currentTempoCount;
+	this->seconds = currentSeconds;
+	this->stepCount += steps;
+	if (this->doNotes)
+		this->trailingSilenceSeconds = currentSilence;
+	if (steps)
+		for (uint8_t i = 0; i < this->nTracks; ++i)
+			if (!this->tracks[i].state[TS_END])
+				this->tracks[i].wait -= static_cast<int>(steps);
+	return keepGoing;
+}
+
 Time TimerPlayer::Length()
 {
 	uint32_t tracksLooped = 0, tracksEnded = 0;
@@ -151,22 +259,96 @@ Time TimerPlayer::Length()
 	return Time(-1, LOOP);
 }
 
-void TimerPlayer::LockMutex()
+// The most values kept for the states seen by FindExactLoop, about 16 MB,
+// after which only the states already kept are looked for
+static const size_t MaxExactLoopStateValues = 1 << 22;
+// How many more times the tracks' own loops are played while looking for a
+// repeated state after the tracks have looped on their own
+static const uint32_t ExactLoopSearchLoops = 4;
+
+// Checks if the player is back in a state it was in before, in which case it
+// will only ever repeat what it did since then.  If so, the intro is the time
+// up to when that state was first seen and the loop is the time since then,
+// and the length is set from those.
+// The tempo count is only part of the state once the tracks repeat.  When it
+// differs, the repeats can be a tick apart in length, so the loop is found
+// from the first repeat to start with the same tempo count (and as far into
+// it) as an earlier one, after which the ticks repeat as well.  The loop is
+// then the average of the repeats in between.  Until then, loopLength is the
+// average of the repeats so far.
+bool TimerPlayer::FindExactLoop()
 {
-#ifdef _WIN32
-	WaitForSingleObject(this->mutex, INFINITE);
-#else
-	pthread_mutex_lock(&this->mutex);
-#endif
-}
+	if (this->loopSteps)
+	{
+		if (this->stepCount < this->nextLoopStep)
+			return false;
+		uint64_t repeat = (this->stepCount - this->loopStartStep) / this->loopSteps, stepsIntoRepeat = (this->stepCount - this->loopStartStep) % this->loopSteps;
+		this->nextLoopStep = this->loopStartStep + (repeat + 1) * this->loopSteps;
+		auto key = std::make_pair(stepsIntoRepeat, this->tempoCount);
+		auto earlier = this->loopRepeats.find(key);
+		if (earlier == this->loopRepeats.end())
+		{
+			this->loopRepeats[key] = std::make_pair(repeat, this->seconds);
+			this->loopLength = (this->seconds - this->introLength - SecondsPerClockCycle) / repeat;
+			return false;
+		}
+		this->loopLength = (this->seconds - earlier->second.second) / (repeat - earlier->second.first);
+		this->length = Time(this->introLength + this->loops * this->loopLength, LOOP);
+		return true;
+	}
 
-void TimerPlayer::UnlockMutex()
-{
-#ifdef _WIN32
-	ReleaseMutex(this->mutex);
-#else
-	pthread_mutex_unlock(&this->mutex);
-#endif
+	auto &state = this->currentState;
+	state.clear();
+	state.push_back(this->nTracks);
+	state.push_back(this->tempo);
+	state.push_back(this->tempoRate);
+	for (int i = 0; i < 32; ++i)
+		if (this->program->variablesRead[i])
+			state.push_back(this->variables[i]);
+	for (uint8_t i = 0; i < this->nTracks; ++i)
+		this->tracks[i].AppendState(state);
+
+	// 64-bit FNV-1a
+	uint64_t hash = 14695981039346656037ULL;
+	std::for_each(state.begin(), state.end(), [&](int32_t value)
+	{
+		for (int i = 0; i < 4; ++i)
+			hash = (hash ^ ((static_cast<uint32_t>(value) >> (i * 8)) & 0xFF)) * 1099511628211ULL;
+	});
+
+	auto matches = this->stateIndexes.equal_range(hash);
+	for (auto match = matches.first; match != matches.second; ++match)
+	{
+		uint32_t index = match->second;
+		uint32_t start = this->stateOffsets[index], size = this->stateOffsets[index + 1] - start;
+		if (size != state.size() || !std::equal(state.begin(), state.end(), this->states.begin() + start))
+			continue;
+		// The state is kept after the tick it was seen on, so the intro ends as that tick starts
+		this->introLength = this->stateSeconds[index] - SecondsPerClockCycle;
+		this->loopLength = this->seconds - this->stateSeconds[index];
+		if (this->tempoCount == this->stateTempoCounts[index])
+		{
+			this->length = Time(this->introLength + this->loops * this->loopLength, LOOP);
+			return true;
+		}
+		this->loopStartStep = this->stateSteps[index];
+		this->loopSteps = this->stepCount - this->loopStartStep;
+		this->nextLoopStep = this->stepCount + this->loopSteps;
+		this->loopRepeats[std::make_pair(0, this->stateTempoCounts[index])] = std::make_pair(0, this->stateSeconds[index]);
+		this->loopRepeats[std::make_pair(0, this->tempoCount)] = std::make_pair(1, this->seconds);
+		return false;
+	}
+
+	if (this->states.size() + state.size() <= MaxExactLoopStateValues)
+	{
+		this->stateIndexes.insert(std::make_pair(hash, static_cast<uint32_t>(this->stateSeconds.size())));
+		this->states.insert(this->states.end(), state.begin(), state.end());
+		this->stateOffsets.push_back(this->states.size());
+		this->stateSeconds.push_back(this->seconds);
+		this->stateSteps.push_back(this->stepCount);
+		this->stateTempoCounts.push_back(this->tempoCount);
+	}
+	return false;
 }
 
 static inline int32_t muldiv7(int32_t val, uint8_t mul)
@@ -180,19 +362,36 @@ void TimerPlayer::GetLength()
 	try
 	{
 		this->length = Time();
+		// Random values aren't part of the player's state
+		bool checkExactLoops = this->exactLoops && !this->doNotes && this->program->predictable;
+		Time trackLoopsLength(-1, LOOP);
+		// Once the tracks have looped on their own, a repeated state is only
+		// looked for a while longer, but once one is found, how many ticks the
+		// repeats take is looked for up to maxSeconds
+		double exactLoopSearchSeconds = this->maxSeconds;
+		// Once the tracks are known to repeat, the best length so far comes from
+		// the average of their repeats, otherwise from the tracks looping on their own
+		auto lengthSoFar = [&]()
+		{
+			return this->loopSteps ? Time(this->introLength + this->loops * this->loopLength, LOOP) : trackLoopsLength;
+		};
 		for (;;)
 		{
-			this->LockMutex();
-			bool doingLength = this->doLength;
-			this->UnlockMutex();
-			if (!doingLength)
+			if (!this->IsDoingLength())
 			{
-				this->length = Time(-1, LOOP);
+				this->length = lengthSoFar();
 				return;
 			}
 
+			double stopSeconds = this->loopSteps ? this->maxSeconds : exactLoopSearchSeconds;
+
 			if (this->doNotes)
 			{
+				// Nothing can be heard until a track plays another note once every channel has stopped
+				bool channelsStopped = std::all_of(this->channels, this->channels + 16, [](const TimerChannel &chn) { return chn.state == CS_NONE; });
+				if (channelsStopped && !this->FastForward(stopSeconds))
+					break;
+
 				int32_t leftChannel = 0, rightChannel = 0;
 
 				// I need to advance the sound channels here
@@ -202,6 +401,13 @@ void TimerPlayer::GetLength()
 
 					if (chn.state > CS_NONE)
 					{
+						// A channel at no volume can't be heard, but the noise generator has to be kept in step with its position
+						if (!chn.reg.volumeMul && (chn.reg.format != 3 || chn.chnId < 14))
+						{
+							chn.IncrementSample();
+							continue;
+						}
+
 						int32_t sample = chn.GenerateSample();
 						chn.IncrementSample();
 
@@ -215,9 +421,7 @@ void TimerPlayer::GetLength()
 					}
 				}
 
-				clamp(leftChannel, std::numeric_limits<int16_t>::min(), std::numeric_limits<int16_t>::max());
-				clamp(rightChannel, std::numeric_limits<int16_t>::min(), std::numeric_limits<int16_t>::max());
-
+				// Only whether the mix is silent matters here, so it doesn't need to be clamped
 				if (!leftChannel && !rightChannel)
 					this->trailingSilenceSeconds += SecondsPerClockCycle;
 				else if (trailingSilenceSeconds > 0)
@@ -228,10 +432,12 @@ void TimerPlayer::GetLength()
 				for (int i = 0; i < 16; ++i)
 					this->channels[i].Update();
 			}
+			else if (!this->FastForward(stopSeconds))
+				break;
 
 			this->Run();
 
-			if (this->doNotes && this->trailingSilenceSeconds >= 20.0)
+			if (this->doNotes && this->trailingSilenceSeconds >= SecondsOfSilenceAtEnd)
 			{
 				double time = this->seconds - this->trailingSilenceSeconds;
 				this->length = Time(time < 0 ? 0 : time, END);
@@ -243,17 +449,36 @@ void TimerPlayer::GetLength()
 			{
 				this->length = this->Length();
 				if (static_cast<int>(this->length.time) != -1)
+				{
+					// The tracks looping on their own only gives the length if the player
+					// doesn't repeat its state soon after
+					if (!checkExactLoops || this->length.type == END)
+					{
+						success = true;
+						break;
+					}
+					if (static_cast<int>(trackLoopsLength.time) == -1)
+					{
+						trackLoopsLength = this->length;
+						exactLoopSearchSeconds = std::min<double>(this->maxSeconds,
+							trackLoopsLength.time + ExactLoopSearchLoops * trackLoopsLength.time / std::max<uint32_t>(this->loops, 1));
+					}
+				}
+				if (checkExactLoops && this->IsDoingLength() && this->FindExactLoop())
 				{
 					success = true;
 					break;
 				}
 			}
-			if (this->seconds > maxSeconds)
+			if (this->seconds > stopSeconds)
 				break;
 		}
-		this->LockMutex();
+		if (!success)
+		{
+			this->length = lengthSoFar();
+			success = static_cast<int>(this->length.time) != -1;
+		}
 		this->doLength = false;
-		this->UnlockMutex();
 	}
 	catch (const std::exception &)
 	{
@@ -274,6 +499,10 @@ void *TimerPlayer::GetLengthThread(void *handle)
 #ifdef _WIN32
 	return 0;
 #else
+	pthread_mutex_lock(&player->finishedMutex);
+	player->finished = true;
+	pthread_cond_signal(&player->finishedCondition);
+	pthread_mutex_unlock(&player->finishedMutex);
 	return nullptr;
 #endif
 }
@@ -285,10 +514,37 @@ void TimerPlayer::StartLengthThread()
 	DWORD threadID;
 	this->thread = CreateThread(nullptr, 0, TimerPlayer::GetLengthThread, this, 0, &threadID);
 #else
+	this->finished = false;
 	pthread_create(&this->thread, nullptr, TimerPlayer::GetLengthThread, this);
 #endif
 }
 
+// Waits for the length thread to be done, for up to the given number of
+// milliseconds, returning true if it was done by then
+bool TimerPlayer::WaitForLength(uint32_t milliseconds)
+{
+#ifdef _WIN32
+	return WaitForSingleObject(this->thread, milliseconds) == WAIT_OBJECT_0;
+#else
+	timespec deadline;
+	clock_gettime(FinishedClock, &deadline);
+	deadline.tv_sec += milliseconds / 1000;
+	deadline.tv_nsec += (milliseconds % 1000) * 1000000L;
+	if (deadline.tv_nsec >= 1000000000L)
+	{
+		++deadline.tv_sec;
+		deadline.tv_nsec -= 1000000000L;
+	}
+	pthread_mutex_lock(&this->finishedMutex);
+	int result = 0;
+	while (!this->finished && result != ETIMEDOUT)
+		result = pthread_cond_timedwait(&this->finishedCondition, &this->finishedMutex, &deadline);
+	bool finishedInTime = this->finished;
+	pthread_mutex_unlock(&this->finishedMutex);
+	return finishedInTime;
+#endif
+}
+
 void TimerPlayer::WaitForThread()
 {
 #ifdef _WIN32
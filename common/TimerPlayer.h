@@ -1,7 +1,7 @@
 /*
  * SDAT - Timer Player structure
  * By Naram Qashat (CyberBotX) [cyberbotx@cyberbotx.com]
- * Last modification on 2014-12-08
+ * Last modification on 2026-10-17
  *
  * Adapted from source code of FeOS Sound System
  * By fincs
@@ -12,7 +12,10 @@
 
 #pragma once
 
+#include <atomic>
 #include <bitset>
+#include <map>
+#include <memory>
 #include "TimerTrack.h"
 #include "TimerChannel.h"
 #include "SSEQ.h"
@@ -64,33 +67,65 @@ struct TimerPlayer
 	const SWAR *swar[4];
 
 	double seconds;
+	// How many steps the tracks have taken, for FindExactLoop to tell which
+	// repeat of a loop it is in
+	uint64_t stepCount;
 
 #ifdef _WIN32
-	HANDLE mutex, thread;
+	HANDLE thread;
 #else
-	pthread_mutex_t mutex;
 	pthread_t thread;
+	// Signalled by the length thread when it is done, so waiting for it can
+	// stop at a deadline (Windows can wait on the thread itself instead)
+	pthread_mutex_t finishedMutex;
+	pthread_cond_t finishedCondition;
+	bool finished;
 #endif
 	uint32_t maxSeconds, loops;
-	bool doLength, doNotes;
+	// Set while the length is being found, clearing it from another thread
+	// cancels finding the length.  Only the flag itself is shared, so relaxed
+	// loads are enough to check it.
+	std::atomic<bool> doLength;
+	bool doNotes;
 	Time length;
+	std::shared_ptr<const TimerProgram> program;
+	// When set, the length is also found from the player coming back to a
+	// state it was in before, giving the intro and loop lengths even for SSEQs
+	// that don't loop with SSEQ_CMD_GOTO.  Only used without the notes.
+	bool exactLoops;
+	double introLength, loopLength;
+	// Every state seen so far, one after another, along with where each one
+	// starts (and where the next one would), when it was seen, the step and
+	// tempo count it was seen at and their hashes
+	std::vector<int32_t> states, currentState;
+	std::vector<uint32_t> stateOffsets;
+	std::vector<double> stateSeconds;
+	std::vector<uint64_t> stateSteps;
+	std::vector<uint16_t> stateTempoCounts;
+	std::unordered_multimap<uint64_t, uint32_t> stateIndexes;
+	// Once a state repeats, the tracks repeat every loopSteps steps from
+	// loopStartStep on, but the tempo count, and so the ticks each repeat
+	// takes, can differ from one repeat to the next.  Each repeat seen is
+	// kept by how many steps past its start it was seen at and the tempo count
+	// then, giving which repeat it was and when it was seen.
+	uint64_t loopStartStep, loopSteps, nextLoopStep;
+	std::map<std::pair<uint64_t, uint16_t>, std::pair<uint64_t, double>> loopRepeats;
 
 	TimerPlayer();
+	~TimerPlayer();
 
-#ifdef _WIN32
-	~TimerPlayer()
+	bool IsDoingLength() const
 	{
-		CloseHandle(this->mutex);
+		return this->doLength.load(std::memory_order_relaxed);
 	}
-#endif
 
-	void Setup(const SSEQ *sseqToPlay, const std::string &filename);
+	void Setup(const SSEQ *sseqToPlay, const std::shared_ptr<const TimerProgram> &sseqProgram = nullptr);
 	int ChannelAlloc(int type, int priority);
 	void Run();
 	void UpdateTracks();
+	bool FastForward(double stopSeconds);
 	Time Length();
-	void LockMutex();
-	void UnlockMutex();
+	bool FindExactLoop();
 	void GetLength();
 
 #ifdef _WIN32
@@ -99,5 +134,6 @@ struct TimerPlayer
 	static void *GetLengthThread(void *handle);
 #endif
 	void StartLengthThread();
+	bool WaitForLength(uint32_t milliseconds);
 	void WaitForThread();
 };
@@ -1,7 +1,7 @@
 /*
  * SDAT - Timer Track structure
  * By Naram Qashat (CyberBotX) [cyberbotx@cyberbotx.com]
- * Last modification on 2014-12-08
+ * Last modification on 2026-10-17
  *
  * Adapted from source code of FeOS Sound System
  * By fincs
@@ -40,16 +40,12 @@ static inline int Cnv_Fall(int fall)
 		return (0x1E00 / (0x7E - fall)) & 0xFFFF;
 }
 
-TimerTrack::TimerTrack() : trackId(-1), state(), prio(0), ply(nullptr), startPos(0), file(), stackPos(0), overriding(), lastComparisonResult(false), wait(0), patch(0), portaKey(0), portaTime(0),
+TimerTrack::TimerTrack() : trackId(-1), state(), prio(0), ply(nullptr), program(nullptr), pos(0), stackPos(0), overriding(), lastComparisonResult(false), wait(0), patch(0), portaKey(0), portaTime(0),
 	sweepPitch(0), vol(0), expr(0), pan(0), pitchBendRange(0), pitchBend(0), transpose(0), a(0), d(0), s(0), r(0), modType(0), modSpeed(0), modDepth(0), modRange(0), modDelay(0), updateFlags(),
 	hitLoop(false), hitEnd(false)
 {
 	std::fill_n(&this->stack[0], TRACKSTACKSIZE, StackValue());
 	memset(this->loopCount, 0, sizeof(this->loopCount));
-	this->read8 = std::bind(&TimerTrack::Read8, this);
-	this->read16 = std::bind(&TimerTrack::Read16, this);
-	this->read24 = std::bind(&TimerTrack::Read24, this);
-	this->readvl = std::bind(&TimerTrack::ReadVL, this);
 }
 
 // Original FSS Function: Track_ClearState
@@ -83,12 +79,12 @@ void TimerTrack::ClearState()
 }
 
 // Original FSS Function: Player_InitTrack
-void TimerTrack::Init(uint8_t handle, TimerPlayer *player, const PseudoReadFile &source)
+void TimerTrack::Init(uint8_t handle, TimerPlayer *player, const TimerProgram *sseqProgram, uint32_t startPos)
 {
 	this->trackId = handle;
 	this->ply = player;
-	this->file.GetDataFromVector(source.data.begin(), source.data.end());
-	this->file.pos = this->startPos = source.pos;
+	this->program = sseqProgram;
+	this->pos = startPos;
 	this->ClearState();
 }
 
@@ -162,7 +158,7 @@ int TimerTrack::NoteOn(int key, int vel, int len)
 		}
 		// TODO: figure out what pNoteDef->tnote means for PSG channels
 		chn->tempReg.TIMER = -SOUND_FREQ(440 * 8); // key #69 (A4)
-		chn->reg.samplePosition = -1;
+		chn->reg.samplePosition = -(INT64_C(1) << SAMPLE_POSITION_SHIFT);
 		chn->reg.psgX = 0x7FFF;
 	}
 
@@ -175,11 +171,12 @@ int TimerTrack::NoteOn(int key, int vel, int len)
 
 		const auto swav = this->ply->swar[noteDef->swar]->swavs.find(noteDef->swav)->second.get();
 		chn->tempReg.CR = SOUND_FORMAT(swav->waveType & 3) | SOUND_LOOP(!!swav->loop) | SCHANNEL_ENABLE;
+		swav->Decode();
 		chn->tempReg.SOURCE = swav;
 		chn->tempReg.TIMER = swav->time;
 		chn->tempReg.REPEAT_POINT = swav->loopOffset;
 		chn->tempReg.LENGTH = swav->nonLoopLength;
-		chn->reg.samplePosition = -3;
+		chn->reg.samplePosition = -(INT64_C(3) << SAMPLE_POSITION_SHIFT);
 	}
 
 	chn->state = CS_START;
@@ -399,6 +396,21 @@ static inline uint8_t SseqCommandByteCount(int cmd)
 		}
 }
 
+static inline bool HasExtraByte(int cmd)
+{
+	return (cmd >= SSEQ_CMD_SETVAR && cmd <= SSEQ_CMD_CMP_NE) || cmd < 0x80;
+}
+
+// Only variables 0 to 31 exist, a command given any other variable number has
+// no variable to use
+static inline bool HasVariable(int varNo)
+{
+	return varNo >= 0 && varNo < 32;
+}
+
+typedef int16_t (*VarFunction)(int16_t, int16_t);
+typedef bool (*CompareFunction)(int16_t, int16_t);
+
 static auto varFuncSet = [](int16_t, int16_t value) { return value; };
 static auto varFuncAdd = [](int16_t var, int16_t value) -> int16_t { return var + value; };
 static auto varFuncSub = [](int16_t var, int16_t value) -> int16_t { return var - value; };
@@ -419,7 +431,7 @@ static auto varFuncRand = [](int16_t, int16_t value) -> int16_t
 		return std::rand() % (value + 1);
 };
 
-static inline std::function<int16_t (int16_t, int16_t)> VarFunc(int cmd)
+static inline VarFunction VarFunc(int cmd)
 {
 	switch (cmd)
 	{
@@ -449,7 +461,7 @@ static auto compareFuncLe = [](int16_t a, int16_t b) { return a <= b; };
 static auto compareFuncLt = [](int16_t a, int16_t b) { return a < b; };
 static auto compareFuncNe = [](int16_t a, int16_t b) { return a != b; };
 
-static inline std::function<bool (int16_t, int16_t)> CompareFunc(int cmd)
+static inline CompareFunction CompareFunc(int cmd)
 {
 	switch (cmd)
 	{
@@ -470,6 +482,447 @@ static inline std::function<bool (int16_t, int16_t)> CompareFunc(int cmd)
 	}
 }
 
+// The operations a TimerInstruction can perform, kept dense so the
+// interpreter's switch becomes a single jump table
+enum TimerOp
+{
+	OP_FAIL,
+	OP_NOP,
+	OP_NOTE,
+	OP_OPENTRACK,
+	OP_REST,
+	OP_PATCH,
+	OP_GOTO,
+	OP_CALL,
+	OP_RET,
+	OP_PAN,
+	OP_VOL,
+	OP_MASTERVOL,
+	OP_PRIO,
+	OP_NOTEWAIT,
+	OP_TIE,
+	OP_EXPR,
+	OP_TEMPO,
+	OP_END,
+	OP_LOOPSTART,
+	OP_LOOPEND,
+	OP_TRANSPOSE,
+	OP_PITCHBEND,
+	OP_PITCHBENDRANGE,
+	OP_ATTACK,
+	OP_DECAY,
+	OP_SUSTAIN,
+	OP_RELEASE,
+	OP_PORTAKEY,
+	OP_PORTAFLAG,
+	OP_PORTATIME,
+	OP_SWEEPPITCH,
+	OP_MODDEPTH,
+	OP_MODSPEED,
+	OP_MODTYPE,
+	OP_MODRANGE,
+	OP_MODDELAY,
+	OP_RANDOM,
+	OP_FROMVAR,
+	OP_FROMNOVAR,
+	OP_VAR,
+	OP_CMP,
+	OP_IF
+};
+
+struct TimerProgramDecoder
+{
+	struct PendingInstruction
+	{
+		uint32_t index;
+		int cmd; // -1 if the command is read from the SSEQ, otherwise the command being overridden
+		uint32_t pos;
+	};
+
+	std::vector<TimerInstruction> &instructions;
+	PseudoReadView file;
+	std::vector<uint32_t> instructionAt;
+	std::vector<PendingInstruction> pending;
+
+	TimerProgramDecoder(std::vector<TimerInstruction> &programInstructions, const SharedBytes &data) : instructions(programInstructions), file(data),
+		instructionAt(data.size(), 0), pending()
+	{
+		this->instructions.push_back(TimerInstruction());
+	}
+
+	// Gets the instruction for the command at the given position, queueing it
+	// to be decoded if it hasn't been already
+	uint32_t Resolve(uint32_t pos)
+	{
+		if (pos >= this->file.size)
+			return 0;
+		if (!this->instructionAt[pos])
+		{
+			this->instructionAt[pos] = this->instructions.size();
+			PendingInstruction instruction = { this->instructionAt[pos], -1, pos };
+			this->pending.push_back(instruction);
+			this->instructions.push_back(TimerInstruction());
+		}
+		return this->instructionAt[pos];
+	}
+
+	// Gets a new instruction for the command overridden by the given
+	// SSEQ_CMD_RANDOM or SSEQ_CMD_FROMVAR, with any of its operands that aren't
+	// overridden at the given position.  If the overridden command would be
+	// given a variable that doesn't exist, it does nothing, and as all of its
+	// operands are overridden, the command after it is used instead.
+	uint32_t AddOverridden(const TimerInstruction &overriding, uint32_t pos)
+	{
+		if (overriding.hasExtra && overriding.cmd >= 0x80 && !HasVariable(overriding.arg1))
+			return this->Resolve(pos);
+		PendingInstruction instruction = { static_cast<uint32_t>(this->instructions.size()), overriding.cmd, pos };
+		this->pending.push_back(instruction);
+		this->instructions.push_back(TimerInstruction());
+		return instruction.index;
+	}
+
+	// Gets where SSEQ_CMD_IF continues when it skips the command at the given position
+	uint32_t ResolveSkip(uint32_t pos)
+	{
+		PseudoReadView skipFile = this->file;
+		skipFile.pos = pos;
+		int nextCmd = skipFile.ReadLE<uint8_t>();
+		uint8_t cmdBytes = SseqCommandByteCount(nextCmd);
+		bool variableBytes = !!(cmdBytes & VariableByteCount);
+		bool extraByte = !!(cmdBytes & ExtraByteOnNoteOrVarOrCmp);
+		cmdBytes &= ~(VariableByteCount | ExtraByteOnNoteOrVarOrCmp);
+		if (extraByte)
+		{
+			int extraCmd = skipFile.ReadLE<uint8_t>();
+			if (HasExtraByte(extraCmd))
+				++cmdBytes;
+		}
+		skipFile.pos += cmdBytes;
+		if (variableBytes)
+			skipFile.ReadVL();
+		return this->Resolve(skipFile.pos);
+	}
+
+	void Decode(const PendingInstruction &pendingInstruction)
+	{
+		TimerInstruction instruction;
+		try
+		{
+			PseudoReadView reader = this->file;
+			reader.pos = pendingInstruction.pos;
+			bool overridden = pendingInstruction.cmd != -1;
+			int cmd = overridden ? pendingInstruction.cmd : reader.ReadLE<uint8_t>();
+			instruction.cmd = cmd;
+			instruction.overridden = overridden;
+			// Operands that can be overridden are not in the SSEQ when they are
+			auto value8 = [&]() { return overridden ? 0 : static_cast<int>(reader.ReadLE<uint8_t>()); };
+			auto value16 = [&]() { return overridden ? 0 : static_cast<int>(reader.ReadLE<uint16_t>()); };
+			auto valueVL = [&]() { return overridden ? 0 : reader.ReadVL(); };
+			bool hasNext = true;
+			if (cmd < 0x80)
+			{
+				instruction.op = OP_NOTE;
+				instruction.arg1 = value8();
+				instruction.arg2 = valueVL();
+			}
+			else
+				switch (cmd)
+				{
+					case SSEQ_CMD_OPENTRACK:
+						instruction.op = OP_OPENTRACK;
+						reader.ReadLE<uint8_t>();
+						instruction.target = this->Resolve(reader.Read24());
+						break;
+
+					case SSEQ_CMD_REST:
+						instruction.op = OP_REST;
+						instruction.arg1 = valueVL();
+						break;
+
+					case SSEQ_CMD_PATCH:
+						instruction.op = OP_PATCH;
+						instruction.arg1 = valueVL();
+						break;
+
+					case SSEQ_CMD_GOTO:
+						instruction.op = OP_GOTO;
+						instruction.target = this->Resolve(reader.Read24());
+						hasNext = false;
+						break;
+
+					case SSEQ_CMD_CALL:
+						instruction.op = OP_CALL;
+						instruction.target = this->Resolve(reader.Read24());
+						break;
+
+					case SSEQ_CMD_RET:
+						instruction.op = OP_RET;
+						break;
+
+					case SSEQ_CMD_PAN:
+						instruction.op = OP_PAN;
+						instruction.arg1 = value8();
+						break;
+
+					case SSEQ_CMD_VOL:
+						instruction.op = OP_VOL;
+						instruction.arg1 = value8();
+						break;
+
+					case SSEQ_CMD_MASTERVOL:
+						instruction.op = OP_MASTERVOL;
+						instruction.arg1 = value8();
+						break;
+
+					case SSEQ_CMD_PRIO:
+						instruction.op = OP_PRIO;
+						instruction.arg1 = reader.ReadLE<uint8_t>();
+						break;
+
+					case SSEQ_CMD_NOTEWAIT:
+						instruction.op = OP_NOTEWAIT;
+						instruction.arg1 = reader.ReadLE<uint8_t>();
+						break;
+
+					case SSEQ_CMD_TIE:
+						instruction.op = OP_TIE;
+						instruction.arg1 = reader.ReadLE<uint8_t>();
+						break;
+
+					case SSEQ_CMD_EXPR:
+						instruction.op = OP_EXPR;
+						instruction.arg1 = value8();
+						break;
+
+					case SSEQ_CMD_TEMPO:
+						instruction.op = OP_TEMPO;
+						instruction.arg1 = reader.ReadLE<uint16_t>();
+						break;
+
+					case SSEQ_CMD_END:
+						instruction.op = OP_END;
+						hasNext = false;
+						break;
+
+					case SSEQ_CMD_LOOPSTART:
+						instruction.op = OP_LOOPSTART;
+						instruction.arg1 = value8();
+						break;
+
+					case SSEQ_CMD_LOOPEND:
+						instruction.op = OP_LOOPEND;
+						break;
+
+					case SSEQ_CMD_TRANSPOSE:
+						instruction.op = OP_TRANSPOSE;
+						instruction.arg1 = value8();
+						break;
+
+					case SSEQ_CMD_PITCHBEND:
+						instruction.op = OP_PITCHBEND;
+						instruction.arg1 = value8();
+						break;
+
+					case SSEQ_CMD_PITCHBENDRANGE:
+						instruction.op = OP_PITCHBENDRANGE;
+						instruction.arg1 = reader.ReadLE<uint8_t>();
+						break;
+
+					case SSEQ_CMD_ATTACK:
+						instruction.op = OP_ATTACK;
+						instruction.arg1 = value8();
+						break;
+
+					case SSEQ_CMD_DECAY:
+						instruction.op = OP_DECAY;
+						instruction.arg1 = value8();
+						break;
+
+					case SSEQ_CMD_SUSTAIN:
+						instruction.op = OP_SUSTAIN;
+						instruction.arg1 = value8();
+						break;
+
+					case SSEQ_CMD_RELEASE:
+						instruction.op = OP_RELEASE;
+						instruction.arg1 = value8();
+						break;
+
+					case SSEQ_CMD_PORTAKEY:
+						instruction.op = OP_PORTAKEY;
+						instruction.arg1 = reader.ReadLE<uint8_t>();
+						break;
+
+					case SSEQ_CMD_PORTAFLAG:
+						instruction.op = OP_PORTAFLAG;
+						instruction.arg1 = reader.ReadLE<uint8_t>();
+						break;
+
+					case SSEQ_CMD_PORTATIME:
+						instruction.op = OP_PORTATIME;
+						instruction.arg1 = value8();
+						break;
+
+					case SSEQ_CMD_SWEEPPITCH:
+						instruction.op = OP_SWEEPPITCH;
+						instruction.arg1 = value16();
+						break;
+
+					case SSEQ_CMD_MODDEPTH:
+						instruction.op = OP_MODDEPTH;
+						instruction.arg1 = value8();
+						break;
+
+					case SSEQ_CMD_MODSPEED:
+						instruction.op = OP_MODSPEED;
+						instruction.arg1 = value8();
+						break;
+
+					case SSEQ_CMD_MODTYPE:
+						instruction.op = OP_MODTYPE;
+						instruction.arg1 = reader.ReadLE<uint8_t>();
+						break;
+
+					case SSEQ_CMD_MODRANGE:
+						instruction.op = OP_MODRANGE;
+						instruction.arg1 = reader.ReadLE<uint8_t>();
+						break;
+
+					case SSEQ_CMD_MODDELAY:
+						instruction.op = OP_MODDELAY;
+						instruction.arg1 = value16();
+						break;
+
+					// The overridden command is always the next instruction, cmd holds which command it is
+					case SSEQ_CMD_RANDOM:
+						instruction.op = OP_RANDOM;
+						instruction.cmd = reader.ReadLE<uint8_t>();
+						if (HasExtraByte(instruction.cmd))
+						{
+							instruction.hasExtra = true;
+							instruction.arg1 = reader.ReadLE<uint8_t>();
+						}
+						instruction.arg2 = static_cast<int16_t>(reader.ReadLE<uint16_t>());
+						instruction.arg3 = static_cast<int16_t>(reader.ReadLE<uint16_t>());
+						instruction.next = this->AddOverridden(instruction, reader.pos);
+						hasNext = false;
+						break;
+
+					case SSEQ_CMD_FROMVAR:
+						instruction.op = OP_FROMVAR;
+						instruction.cmd = reader.ReadLE<uint8_t>();
+						if (HasExtraByte(instruction.cmd))
+						{
+							instruction.hasExtra = true;
+							instruction.arg1 = reader.ReadLE<uint8_t>();
+						}
+						instruction.arg2 = reader.ReadLE<uint8_t>();
+						// A variable that doesn't exist gives 0
+						if (!HasVariable(instruction.arg2))
+							instruction.op = OP_FROMNOVAR;
+						instruction.next = this->AddOverridden(instruction, reader.pos);
+						hasNext = false;
+						break;
+
+					case SSEQ_CMD_SETVAR:
+					case SSEQ_CMD_ADDVAR:
+					case SSEQ_CMD_SUBVAR:
+					case SSEQ_CMD_MULVAR:
+					case SSEQ_CMD_DIVVAR:
+					case SSEQ_CMD_SHIFTVAR:
+					case SSEQ_CMD_RANDVAR:
+						instruction.op = OP_VAR;
+						instruction.arg1 = value8();
+						instruction.arg2 = value16();
+						if (!overridden && !HasVariable(instruction.arg1))
+							instruction.op = OP_NOP;
+						break;
+
+					case SSEQ_CMD_CMP_EQ:
+					case SSEQ_CMD_CMP_GE:
+					case SSEQ_CMD_CMP_GT:
+					case SSEQ_CMD_CMP_LE:
+					case SSEQ_CMD_CMP_LT:
+					case SSEQ_CMD_CMP_NE:
+						instruction.op = OP_CMP;
+						instruction.arg1 = value8();
+						instruction.arg2 = value16();
+						if (!overridden && !HasVariable(instruction.arg1))
+							instruction.op = OP_NOP;
+						break;
+
+					// The skipped command is only read if the comparison was false, so it can only fail then
+					case SSEQ_CMD_IF:
+						instruction.op = OP_IF;
+						try
+						{
+							instruction.target = this->ResolveSkip(reader.pos);
+						}
+						catch (const std::exception &)
+						{
+							instruction.target = 0;
+						}
+						break;
+
+					default:
+						instruction.op = OP_NOP;
+						reader.pos += SseqCommandByteCount(cmd);
+				}
+			if (hasNext)
+				instruction.next = this->Resolve(reader.pos);
+		}
+		catch (const std::exception &)
+		{
+			instruction = TimerInstruction();
+		}
+		this->instructions[pendingInstruction.index] = instruction;
+	}
+};
+
+TimerProgram::TimerProgram(const SharedBytes &data) : instructions(), start(0), predictable(true), variablesRead()
+{
+	TimerProgramDecoder decoder(this->instructions, data);
+	this->start = decoder.Resolve(0);
+	while (!decoder.pending.empty())
+	{
+		auto pendingInstruction = decoder.pending.back();
+		decoder.pending.pop_back();
+		decoder.Decode(pendingInstruction);
+	}
+
+	// SSEQ_CMD_RANDOM doesn't use a random value when it overrides a Note-On
+	// command, and the variable numbers of overridden commands come from the
+	// SSEQ_CMD_RANDOM or SSEQ_CMD_FROMVAR before them
+	std::for_each(this->instructions.begin(), this->instructions.end(), [&](const TimerInstruction &instruction)
+	{
+		bool overridesComparison = instruction.hasExtra && instruction.cmd >= SSEQ_CMD_CMP_EQ && instruction.cmd <= SSEQ_CMD_CMP_NE &&
+			HasVariable(instruction.arg1);
+		switch (instruction.op)
+		{
+			case OP_RANDOM:
+				if (instruction.cmd >= 0x80)
+					this->predictable = false;
+				break;
+			case OP_FROMVAR:
+				this->variablesRead.set(instruction.arg2);
+				if (overridesComparison)
+					this->variablesRead.set(instruction.arg1);
+				break;
+			case OP_FROMNOVAR:
+				if (overridesComparison)
+					this->variablesRead.set(instruction.arg1);
+				break;
+			case OP_VAR:
+				if (instruction.cmd == SSEQ_CMD_RANDVAR)
+					this->predictable = false;
+				break;
+			case OP_CMP:
+				if (!instruction.overridden)
+					this->variablesRead.set(instruction.arg1);
+		}
+	});
+}
+
 // Original FSS Function: Track_Run
 void TimerTrack::Run()
 {
@@ -487,328 +940,308 @@ void TimerTrack::Run()
 			return;
 	}
 
+	const TimerInstruction *instructions = &this->program->instructions[0];
 	while (!this->wait)
 	{
-		this->ply->LockMutex();
-		bool doingLength = this->ply->doLength;
-		this->ply->UnlockMutex();
-		if (!doingLength)
+		// A track that loops without waiting would never finish the tick, so it also has to check for being cancelled
+		if (!this->ply->IsDoingLength())
 			break;
 
-		int cmd;
-		if (this->overriding())
-			cmd = this->overriding.cmd;
-		else
-			cmd = this->Read8();
-		if (cmd < 0x80)
+		const TimerInstruction &instruction = instructions[this->pos];
+		this->pos = instruction.next;
+		// The operand of commands with only 1, whether it was overridden or not
+		int value = instruction.overridden ? this->overriding.value : instruction.arg1;
+		switch (instruction.op)
 		{
-			// Note on
-			int key = cmd + this->transpose;
-			int vel = this->overriding.val(this->read8, true);
-			int len = this->overriding.val(this->readvl);
-			if (this->state[TS_NOTEWAIT])
-				this->wait = len;
-			if (this->ply->doNotes)
-			{
-				if (this->state[TS_TIEBIT])
-					this->NoteOnTie(key, vel);
-				else
-					this->NoteOn(key, vel, len);
-			}
-		}
-		else
-		{
-			int value;
-			switch (cmd)
-			{
-				//-----------------------------------------------------------------
-				// Main commands
-				//-----------------------------------------------------------------
+			case OP_FAIL:
+				throw std::range_error("PseudoReadView position was set past the end of the data.");
 
-				case SSEQ_CMD_OPENTRACK:
+			case OP_NOP:
+				break;
+
+			case OP_NOTE:
+			{
+				int key = instruction.cmd + this->transpose;
+				int vel = instruction.overridden ? this->overriding.extraValue : instruction.arg1;
+				int len = instruction.overridden ? this->overriding.value : instruction.arg2;
+				if (this->state[TS_NOTEWAIT])
+					this->wait = len;
+				if (this->ply->doNotes)
 				{
-					this->Read8();
-					PseudoReadFile trackFile = this->file;
-					trackFile.pos = this->Read24();
-					int newTrack = this->ply->nTracks++;
-					this->ply->tracks[newTrack].Init(newTrack, this->ply, trackFile);
-					break;
+					if (this->state[TS_TIEBIT])
+						this->NoteOnTie(key, vel);
+					else
+						this->NoteOn(key, vel, len);
 				}
+				break;
+			}
 
-				case SSEQ_CMD_REST:
-					this->wait = this->overriding.val(this->readvl);
-					break;
+			//-----------------------------------------------------------------
+			// Main commands
+			//-----------------------------------------------------------------
 
-				case SSEQ_CMD_PATCH:
-					this->patch = this->overriding.val(this->readvl);
-					break;
+			case OP_OPENTRACK:
+			{
+				int newTrack = this->ply->nTracks++;
+				this->ply->tracks[newTrack].Init(newTrack, this->ply, this->program, instruction.target);
+				break;
+			}
 
-				case SSEQ_CMD_GOTO:
-					this->file.pos = this->Read24();
-					this->hitLoop = true;
-					break;
+			case OP_REST:
+				this->wait = value;
+				break;
 
-				case SSEQ_CMD_CALL:
-					value = this->Read24();
-					if (this->stackPos < TRACKSTACKSIZE)
-					{
-						this->stack[this->stackPos++] = StackValue(STACKTYPE_CALL, this->file.pos);
-						this->file.pos = value;
-					}
-					break;
+			case OP_PATCH:
+				this->patch = value;
+				break;
 
-				case SSEQ_CMD_RET:
-					if (this->stackPos && this->stack[this->stackPos - 1].type == STACKTYPE_CALL)
-						this->file.pos = this->stack[--this->stackPos].destPos;
-					break;
+			case OP_GOTO:
+				this->pos = instruction.target;
+				this->hitLoop = true;
+				break;
 
-				case SSEQ_CMD_PAN:
-					this->pan = this->overriding.val(this->read8) - 64;
-					this->updateFlags.set(TUF_PAN);
-					break;
+			case OP_CALL:
+				if (this->stackPos < TRACKSTACKSIZE)
+				{
+					this->stack[this->stackPos++] = StackValue(STACKTYPE_CALL, this->pos);
+					this->pos = instruction.target;
+				}
+				break;
 
-				case SSEQ_CMD_VOL:
-					this->vol = this->overriding.val(this->read8);
-					this->updateFlags.set(TUF_VOL);
-					break;
+			case OP_RET:
+				if (this->stackPos && this->stack[this->stackPos - 1].type == STACKTYPE_CALL)
+					this->pos = this->stack[--this->stackPos].destPos;
+				break;
 
-				case SSEQ_CMD_MASTERVOL:
-					this->ply->masterVol = Cnv_Sust(this->overriding.val(this->read8));
-					for (uint8_t i = 0; i < this->ply->nTracks; ++i)
-						this->ply->tracks[i].updateFlags.set(TUF_VOL);
-					break;
+			case OP_PAN:
+				this->pan = value - 64;
+				this->updateFlags.set(TUF_PAN);
+				break;
 
-				case SSEQ_CMD_PRIO:
-					this->prio = this->ply->prio + this->Read8();
-					break;
+			case OP_VOL:
+				this->vol = value;
+				this->updateFlags.set(TUF_VOL);
+				break;
 
-				case SSEQ_CMD_NOTEWAIT:
-					this->state.set(TS_NOTEWAIT, !!this->Read8());
-					break;
+			case OP_MASTERVOL:
+				this->ply->masterVol = Cnv_Sust(value);
+				for (uint8_t i = 0; i < this->ply->nTracks; ++i)
+					this->ply->tracks[i].updateFlags.set(TUF_VOL);
+				break;
 
-				case SSEQ_CMD_TIE:
-					this->state.set(TS_TIEBIT, !!this->Read8());
-					this->ReleaseAllNotes();
-					break;
+			case OP_PRIO:
+				this->prio = this->ply->prio + instruction.arg1;
+				break;
 
-				case SSEQ_CMD_EXPR:
-					this->expr = this->overriding.val(this->read8);
-					this->updateFlags.set(TUF_VOL);
-					break;
+			case OP_NOTEWAIT:
+				this->state.set(TS_NOTEWAIT, !!instruction.arg1);
+				break;
 
-				case SSEQ_CMD_TEMPO:
-					this->ply->tempo = this->Read16();
-					break;
+			case OP_TIE:
+				this->state.set(TS_TIEBIT, !!instruction.arg1);
+				this->ReleaseAllNotes();
+				break;
 
-				case SSEQ_CMD_END:
-					this->state.set(TS_END);
-					this->hitEnd = true;
-					return;
+			case OP_EXPR:
+				this->expr = value;
+				this->updateFlags.set(TUF_VOL);
+				break;
 
-				case SSEQ_CMD_LOOPSTART:
-					value = this->overriding.val(this->read8);
-					if (this->stackPos < TRACKSTACKSIZE)
-					{
-						this->loopCount[this->stackPos] = value;
-						this->stack[this->stackPos++] = StackValue(STACKTYPE_LOOP, this->file.pos);
-					}
-					break;
+			case OP_TEMPO:
+				this->ply->tempo = instruction.arg1;
+				break;
 
-				case SSEQ_CMD_LOOPEND:
-					if (this->stackPos && this->stack[this->stackPos - 1].type == STACKTYPE_LOOP)
-					{
-						uint32_t rPos = this->stack[this->stackPos - 1].destPos;
-						uint8_t &nR = this->loopCount[this->stackPos - 1];
-						uint8_t prevR = nR;
-						if (!prevR || --nR)
-							this->file.pos = rPos;
-						else
-							--this->stackPos;
-						if (!prevR)
-							this->hitLoop = true;
-					}
-					break;
+			case OP_END:
+				this->state.set(TS_END);
+				this->hitEnd = true;
+				return;
 
-				//-----------------------------------------------------------------
-				// Tuning commands
-				//-----------------------------------------------------------------
+			case OP_LOOPSTART:
+				if (this->stackPos < TRACKSTACKSIZE)
+				{
+					this->loopCount[this->stackPos] = value;
+					this->stack[this->stackPos++] = StackValue(STACKTYPE_LOOP, this->pos);
+				}
+				break;
 
-				case SSEQ_CMD_TRANSPOSE:
-					this->transpose = this->overriding.val(this->read8);
-					break;
+			case OP_LOOPEND:
+				if (this->stackPos && this->stack[this->stackPos - 1].type == STACKTYPE_LOOP)
+				{
+					uint32_t rPos = this->stack[this->stackPos - 1].destPos;
+					uint8_t &nR = this->loopCount[this->stackPos - 1];
+					uint8_t prevR = nR;
+					if (!prevR || --nR)
+						this->pos = rPos;
+					else
+						--this->stackPos;
+					if (!prevR)
+						this->hitLoop = true;
+				}
+				break;
 
-				case SSEQ_CMD_PITCHBEND:
-					this->pitchBend = this->overriding.val(this->read8);
-					this->updateFlags.set(TUF_TIMER);
-					break;
+			//-----------------------------------------------------------------
+			// Tuning commands
+			//-----------------------------------------------------------------
 
-				case SSEQ_CMD_PITCHBENDRANGE:
-					this->pitchBendRange = this->Read8();
-					this->updateFlags.set(TUF_TIMER);
-					break;
+			case OP_TRANSPOSE:
+				this->transpose = value;
+				break;
 
-				//-----------------------------------------------------------------
-				// Envelope-related commands
-				//-----------------------------------------------------------------
+			case OP_PITCHBEND:
+				this->pitchBend = value;
+				this->updateFlags.set(TUF_TIMER);
+				break;
 
-				case SSEQ_CMD_ATTACK:
-					this->a = this->overriding.val(this->read8);
-					break;
+			case OP_PITCHBENDRANGE:
+				this->pitchBendRange = instruction.arg1;
+				this->updateFlags.set(TUF_TIMER);
+				break;
 
-				case SSEQ_CMD_DECAY:
-					this->d = this->overriding.val(this->read8);
-					break;
+			//-----------------------------------------------------------------
+			// Envelope-related commands
+			//-----------------------------------------------------------------
 
-				case SSEQ_CMD_SUSTAIN:
-					this->s = this->overriding.val(this->read8);
-					break;
+			case OP_ATTACK:
+				this->a = value;
+				break;
 
-				case SSEQ_CMD_RELEASE:
-					this->r = this->overriding.val(this->read8);
-					break;
+			case OP_DECAY:
+				this->d = value;
+				break;
 
-				//-----------------------------------------------------------------
-				// Portamento-related commands
-				//-----------------------------------------------------------------
+			case OP_SUSTAIN:
+				this->s = value;
+				break;
 
-				case SSEQ_CMD_PORTAKEY:
-					this->portaKey = this->Read8() + this->transpose;
-					this->state.set(TS_PORTABIT);
-					break;
+			case OP_RELEASE:
+				this->r = value;
+				break;
 
-				case SSEQ_CMD_PORTAFLAG:
-					this->state.set(TS_PORTABIT, !!this->Read8());
-					break;
+			//-----------------------------------------------------------------
+			// Portamento-related commands
+			//-----------------------------------------------------------------
 
-				case SSEQ_CMD_PORTATIME:
-					this->portaTime = this->overriding.val(this->read8);
-					break;
+			case OP_PORTAKEY:
+				this->portaKey = instruction.arg1 + this->transpose;
+				this->state.set(TS_PORTABIT);
+				break;
 
-				case SSEQ_CMD_SWEEPPITCH:
-					this->sweepPitch = this->overriding.val(this->read16);
-					break;
+			case OP_PORTAFLAG:
+				this->state.set(TS_PORTABIT, !!instruction.arg1);
+				break;
 
-				//-----------------------------------------------------------------
-				// Modulation-related commands
-				//-----------------------------------------------------------------
+			case OP_PORTATIME:
+				this->portaTime = value;
+				break;
 
-				case SSEQ_CMD_MODDEPTH:
-					this->modDepth = this->overriding.val(this->read8);
-					this->updateFlags.set(TUF_MOD);
-					break;
+			case OP_SWEEPPITCH:
+				this->sweepPitch = value;
+				break;
 
-				case SSEQ_CMD_MODSPEED:
-					this->modSpeed = this->overriding.val(this->read8);
-					this->updateFlags.set(TUF_MOD);
-					break;
+			//-----------------------------------------------------------------
+			// Modulation-related commands
+			//-----------------------------------------------------------------
 
-				case SSEQ_CMD_MODTYPE:
-					this->modType = this->Read8();
-					this->updateFlags.set(TUF_MOD);
-					break;
+			case OP_MODDEPTH:
+				this->modDepth = value;
+				this->updateFlags.set(TUF_MOD);
+				break;
 
-				case SSEQ_CMD_MODRANGE:
-					this->modRange = this->Read8();
-					this->updateFlags.set(TUF_MOD);
-					break;
+			case OP_MODSPEED:
+				this->modSpeed = value;
+				this->updateFlags.set(TUF_MOD);
+				break;
 
-				case SSEQ_CMD_MODDELAY:
-					this->modDelay = this->overriding.val(this->read16);
-					this->updateFlags.set(TUF_MOD);
-					break;
+			case OP_MODTYPE:
+				this->modType = instruction.arg1;
+				this->updateFlags.set(TUF_MOD);
+				break;
 
-				//-----------------------------------------------------------------
-				// Randomness-related commands
-				//-----------------------------------------------------------------
+			case OP_MODRANGE:
+				this->modRange = instruction.arg1;
+				this->updateFlags.set(TUF_MOD);
+				break;
 
-				case SSEQ_CMD_RANDOM:
-				{
-					this->overriding() = true;
-					this->overriding.cmd = this->Read8();
-					if ((this->overriding.cmd >= SSEQ_CMD_SETVAR && this->overriding.cmd <= SSEQ_CMD_CMP_NE) || this->overriding.cmd < 0x80)
-						this->overriding.extraValue = this->Read8();
-					int16_t minVal = this->Read16();
-					int16_t maxVal = this->Read16();
-					// Special case: If the overriden command is a Note-On command, just use whatever could've been the maximum for it.
-					if (this->overriding.cmd < 0x80)
-						this->overriding.value = maxVal;
-					else
-						this->overriding.value = (std::rand() % (maxVal - minVal + 1)) + minVal;
-					break;
-				}
+			case OP_MODDELAY:
+				this->modDelay = value;
+				this->updateFlags.set(TUF_MOD);
+				break;
 
-				//-----------------------------------------------------------------
-				// Variable-related commands
-				//-----------------------------------------------------------------
+			//-----------------------------------------------------------------
+			// Randomness-related commands
+			//-----------------------------------------------------------------
 
-				case SSEQ_CMD_FROMVAR:
-					this->overriding() = true;
-					this->overriding.cmd = this->Read8();
-					if ((this->overriding.cmd >= SSEQ_CMD_SETVAR && this->overriding.cmd <= SSEQ_CMD_CMP_NE) || this->overriding.cmd < 0x80)
-						this->overriding.extraValue = this->Read8();
-					this->overriding.value = this->ply->variables[this->Read8()];
-					break;
+			case OP_RANDOM:
+				if (instruction.hasExtra)
+					this->overriding.extraValue = instruction.arg1;
+				// Special case: If the overriden command is a Note-On command, just use whatever could've been the maximum for it.
+				if (instruction.cmd < 0x80)
+					this->overriding.value = instruction.arg3;
+				else
+					this->overriding.value = (std::rand() % (instruction.arg3 - instruction.arg2 + 1)) + instruction.arg2;
+				break;
 
-				case SSEQ_CMD_SETVAR:
-				case SSEQ_CMD_ADDVAR:
-				case SSEQ_CMD_SUBVAR:
-				case SSEQ_CMD_MULVAR:
-				case SSEQ_CMD_DIVVAR:
-				case SSEQ_CMD_SHIFTVAR:
-				case SSEQ_CMD_RANDVAR:
-				{
-					int8_t varNo = this->overriding.val(this->read8, true);
-					value = this->overriding.val(this->read16);
-					if (cmd == SSEQ_CMD_DIVVAR && !value) // Division by 0, skip it to prevent crashing
-						break;
-					this->ply->variables[varNo] = VarFunc(cmd)(this->ply->variables[varNo], value);
-					break;
-				}
+			//-----------------------------------------------------------------
+			// Variable-related commands
+			//-----------------------------------------------------------------
 
-				//-----------------------------------------------------------------
-				// Conditional-related commands
-				//-----------------------------------------------------------------
+			case OP_FROMVAR:
+				if (instruction.hasExtra)
+					this->overriding.extraValue = instruction.arg1;
+				this->overriding.value = this->ply->variables[instruction.arg2];
+				break;
 
-				case SSEQ_CMD_CMP_EQ:
-				case SSEQ_CMD_CMP_GE:
-				case SSEQ_CMD_CMP_GT:
-				case SSEQ_CMD_CMP_LE:
-				case SSEQ_CMD_CMP_LT:
-				case SSEQ_CMD_CMP_NE:
-				{
-					int8_t varNo = this->overriding.val(this->read8, true);
-					value = this->overriding.val(this->read16);
-					this->lastComparisonResult = CompareFunc(cmd)(this->ply->variables[varNo], value);
-					break;
-				}
+			case OP_FROMNOVAR:
+				if (instruction.hasExtra)
+					this->overriding.extraValue = instruction.arg1;
+				this->overriding.value = 0;
+				break;
 
-				case SSEQ_CMD_IF:
-					if (!this->lastComparisonResult)
-					{
-						int nextCmd = this->Read8();
-						uint8_t cmdBytes = SseqCommandByteCount(nextCmd);
-						bool variableBytes = !!(cmdBytes & VariableByteCount);
-						bool extraByte = !!(cmdBytes & ExtraByteOnNoteOrVarOrCmp);
-						cmdBytes &= ~(VariableByteCount | ExtraByteOnNoteOrVarOrCmp);
-						if (extraByte)
-						{
-							int extraCmd = this->Read8();
-							if ((extraCmd >= SSEQ_CMD_SETVAR && extraCmd <= SSEQ_CMD_CMP_NE) || extraCmd < 0x80)
-								++cmdBytes;
-						}
-						this->file.pos += cmdBytes;
-						if (variableBytes)
-							this->ReadVL();
-					}
+			case OP_VAR:
+			{
+				int8_t varNo = instruction.overridden ? this->overriding.extraValue : instruction.arg1;
+				value = instruction.overridden ? this->overriding.value : instruction.arg2;
+				if (instruction.cmd == SSEQ_CMD_DIVVAR && !value) // Division by 0, skip it to prevent crashing
 					break;
+				this->ply->variables[varNo] = VarFunc(instruction.cmd)(this->ply->variables[varNo], value);
+				break;
+			}
 
-				default:
-					this->file.pos += SseqCommandByteCount(cmd);
+			//-----------------------------------------------------------------
+			// Conditional-related commands
+			//-----------------------------------------------------------------
+
+			case OP_CMP:
+			{
+				int8_t varNo = instruction.overridden ? this->overriding.extraValue : instruction.arg1;
+				value = instruction.overridden ? this->overriding.value : instruction.arg2;
+				this->lastComparisonResult = CompareFunc(instruction.cmd)(this->ply->variables[varNo], value);
+				break;
 			}
+
+			case OP_IF:
+				if (!this->lastComparisonResult)
+					this->pos = instruction.target;
 		}
+	}
+}
 
-		if (cmd != SSEQ_CMD_RANDOM && cmd != SSEQ_CMD_FROMVAR)
-			this->overriding() = false;
+// Adds everything about the track that decides what it will do next, for
+// TimerPlayer to tell when the SSEQ has come back to a state it was in before
+void TimerTrack::AppendState(std::vector<int32_t> &trackState) const
+{
+	trackState.push_back(this->pos);
+	// A negative wait only runs out after billions of ticks, so the track is
+	// treated as stopped no matter how far it has counted down
+	trackState.push_back(this->wait < 0 ? -1 : this->wait);
+	trackState.push_back(this->state.to_ulong());
+	trackState.push_back(this->lastComparisonResult);
+	trackState.push_back(this->stackPos);
+	for (uint8_t i = 0; i < this->stackPos; ++i)
+	{
+		trackState.push_back(this->stack[i].type);
+		trackState.push_back(this->stack[i].destPos);
+		trackState.push_back(this->loopCount[i]);
 	}
 }
 
@@ -817,13 +1250,12 @@ std::pair<std::vector<uint16_t>, std::vector<uint32_t>> TimerTrack::GetPatches(c
 	return TimerTrack::GetPatches(sseq->data);
 }
 
-std::pair<std::vector<uint16_t>, std::vector<uint32_t>> TimerTrack::GetPatches(const std::vector<uint8_t> &data)
+std::pair<std::vector<uint16_t>, std::vector<uint32_t>> TimerTrack::GetPatches(const SharedBytes &data)
 {
 	std::vector<uint16_t> patches;
 	std::vector<uint32_t> positions;
 
-	PseudoReadFile file;
-	file.GetDataFromVector(data.begin(), data.end());
+	PseudoReadView file(data);
 
 	uint32_t dataSize = data.size();
 
@@ -859,7 +1291,7 @@ std::pair<std::vector<uint16_t>, std::vector<uint32_t>> TimerTrack::GetPatches(c
 					if (extraByte)
 					{
 						int extraCmd = file.ReadLE<uint8_t>();
-						if ((extraCmd >= SSEQ_CMD_SETVAR && extraCmd <= SSEQ_CMD_CMP_NE) || extraCmd < 0x80)
+						if (HasExtraByte(extraCmd))
 							++cmdBytes;
 					}
 					file.pos += cmdBytes;
@@ -885,23 +1317,3 @@ std::pair<std::vector<uint16_t>, std::vector<uint32_t>> TimerTrack::GetPatches(c
 	}
 	return std::make_pair(patches, positions);
 }
-
-int TimerTrack::Read8()
-{
-	return this->file.ReadLE<uint8_t>();
-}
-
-int TimerTrack::Read16()
-{
-	return this->file.ReadLE<uint16_t>();
-}
-
-int TimerTrack::Read24()
-{
-	return this->file.Read24();
-}
-
-int TimerTrack::ReadVL()
-{
-	return this->file.ReadVL();
-}
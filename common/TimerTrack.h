@@ -1,7 +1,7 @@
 /*
  * SDAT - Timer Track
  * By Naram Qashat (CyberBotX) [cyberbotx@cyberbotx.com]
- * Last modification on 2014-11-12
+ * Last modification on 2026-10-17
  *
  * Adapted from source code of FeOS Sound System
  * By fincs
@@ -12,7 +12,6 @@
 
 #pragma once
 
-#include <functional>
 #include <bitset>
 #include "SSEQ.h"
 #include "common.h"
@@ -40,23 +39,63 @@ struct StackValue
 	StackValue(StackType newType, uint32_t newDestPos) : type(newType), destPos(newDestPos) { }
 };
 
+// The values given by the last SSEQ_CMD_RANDOM or SSEQ_CMD_FROMVAR to the
+// command it overrides
 struct Override
 {
-	bool overriding;
-	int cmd;
 	int value;
 	int extraValue;
 
-	Override() : overriding(false) { }
-	bool operator()() const { return this->overriding; }
-	bool &operator()() { return this->overriding; }
-	int val(std::function<int ()> reader, bool returnExtra = false)
-	{
-		if (this->overriding)
-			return returnExtra ? this->extraValue : this->value;
-		else
-			return reader();
-	}
+	Override() : value(0), extraValue(0) { }
+};
+
+/*
+ * A single SSEQ command, decoded ahead of time by TimerProgram.
+ *
+ * arg1, arg2 and arg3 hold the command's operands in the order they are
+ * found in the SSEQ.  next is the instruction run after this one, and target
+ * is the instruction jumped to by SSEQ_CMD_GOTO, SSEQ_CMD_CALL and
+ * SSEQ_CMD_OPENTRACK, or skipped to by SSEQ_CMD_IF when the last comparison
+ * was false.  For SSEQ_CMD_RANDOM and SSEQ_CMD_FROMVAR, cmd is the command
+ * they override and next is that command, which has overridden set so the
+ * operands that can be overridden come from the track's Override instead.
+ * Commands given a variable that doesn't exist are decoded so that they don't
+ * use one: SSEQ_CMD_FROMVAR gives 0 and the other variable commands do nothing.
+ */
+struct TimerInstruction
+{
+	uint8_t op, cmd;
+	bool overridden, hasExtra;
+	int32_t arg1, arg2, arg3;
+	uint32_t next, target;
+
+	TimerInstruction() : op(0), cmd(0), overridden(false), hasExtra(false), arg1(0), arg2(0), arg3(0), next(0), target(0) { }
+};
+
+/*
+ * An SSEQ's commands, decoded once so that the tracks playing it don't have
+ * to read the raw bytes each time a command is run.
+ *
+ * Only the commands that can be reached from the start of the SSEQ are
+ * decoded, starting from each position they can be reached from, so jumps
+ * into the middle of another command still run what the raw bytes would.
+ * Instruction 0 throws the same error that reading past the end of the SSEQ
+ * would, and is used for every command that would have done so.
+ *
+ * predictable is false if any of the commands use random values, as what the
+ * SSEQ does next then depends on more than the state of the player and its
+ * tracks.  variablesRead has the variables
+ * that are compared or given to another command, the others being set never
+ * changes what the SSEQ does.
+ */
+struct TimerProgram
+{
+	std::vector<TimerInstruction> instructions;
+	uint32_t start;
+	bool predictable;
+	std::bitset<32> variablesRead;
+
+	TimerProgram(const SharedBytes &data);
 };
 
 struct TimerTrack
@@ -67,8 +106,8 @@ struct TimerTrack
 	uint8_t prio;
 	TimerPlayer *ply;
 
-	uint32_t startPos;
-	PseudoReadFile file;
+	const TimerProgram *program;
+	uint32_t pos;
 	StackValue stack[TRACKSTACKSIZE];
 	uint8_t stackPos, loopCount[TRACKSTACKSIZE];
 	Override overriding;
@@ -95,18 +134,12 @@ struct TimerTrack
 	TimerTrack();
 
 	void ClearState();
-	void Init(uint8_t handle, TimerPlayer *player, const PseudoReadFile &source);
+	void Init(uint8_t handle, TimerPlayer *player, const TimerProgram *sseqProgram, uint32_t startPos);
 	int NoteOn(int key, int vel, int len);
 	int NoteOnTie(int key, int vel);
 	void ReleaseAllNotes();
 	void Run();
+	void AppendState(std::vector<int32_t> &trackState) const;
 	static std::pair<std::vector<uint16_t>, std::vector<uint32_t>> GetPatches(const SSEQ *sseq);
-	static std::pair<std::vector<uint16_t>, std::vector<uint32_t>> GetPatches(const std::vector<uint8_t> &data);
-
-	int Read8();
-	int Read16();
-	int Read24();
-	int ReadVL();
-
-	std::function<int ()> read8, read16, read24, readvl;
+	static std::pair<std::vector<uint16_t>, std::vector<uint32_t>> GetPatches(const SharedBytes &data);
 };
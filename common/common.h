@@ -1,13 +1,15 @@
 /*
  * SDAT - Common functions
  * By Naram Qashat (CyberBotX) [cyberbotx@cyberbotx.com]
- * Last modification on 2014-11-12
+ * Last modification on 2026-10-17
  */
 
 #pragma once
 
 #include <string>
 #include <memory>
+#include <functional>
+#include <unordered_map>
 #include <vector>
 #include <fstream>
 #include <stdexcept>
@@ -33,79 +35,210 @@
 # define mkdir(dir, mode) _mkdir((dir))
 #endif
 #include "optionparser.h"
+#include "MappedFile.h"
+
+/*
+ * Shared bytes
+ *
+ * A part of a buffer of bytes that is shared by everything that refers to any
+ * part of it.  When an SDAT is read, the data of all of its files is loaded
+ * into a single buffer, and the entries and the files themselves only refer to
+ * their own part of it instead of each holding a copy, which also means that
+ * copies of an SDAT don't copy any of it.  The bytes are never modified, a
+ * file that has to be changed is given a buffer of its own instead.
+ */
+
+class SharedBytes
+{
+	std::shared_ptr<const std::vector<uint8_t>> buffer;
+	size_t offset, length;
+public:
+	SharedBytes() : buffer(), offset(0), length(0)
+	{
+	}
+
+	SharedBytes(std::vector<uint8_t> &&bytes) : buffer(std::make_shared<std::vector<uint8_t>>(std::move(bytes))), offset(0), length(0)
+	{
+		this->length = this->buffer->size();
+	}
+
+	// Refers to a part of the given bytes, which must be within them
+	SharedBytes(const SharedBytes &bytes, size_t partOffset, size_t partLength) : buffer(bytes.buffer), offset(bytes.offset + partOffset), length(partLength)
+	{
+		if (partOffset > bytes.length || partLength > bytes.length - partOffset)
+			throw std::range_error("SharedBytes part was set past the end of the data.");
+	}
+
+	SharedBytes &operator=(std::vector<uint8_t> &&bytes)
+	{
+		this->buffer = std::make_shared<std::vector<uint8_t>>(std::move(bytes));
+		this->offset = 0;
+		this->length = this->buffer->size();
+		return *this;
+	}
+
+	const uint8_t *data() const
+	{
+		return this->length ? &(*this->buffer)[this->offset] : nullptr;
+	}
+
+	size_t size() const
+	{
+		return this->length;
+	}
+
+	bool empty() const
+	{
+		return !this->length;
+	}
+
+	const uint8_t *begin() const
+	{
+		return this->data();
+	}
+
+	const uint8_t *end() const
+	{
+		return this->data() + this->length;
+	}
+
+	const uint8_t &operator[](size_t i) const
+	{
+		return (*this->buffer)[this->offset + i];
+	}
+
+	bool operator==(const SharedBytes &bytes) const
+	{
+		return this->length == bytes.length && (this->data() == bytes.data() || !memcmp(this->data(), bytes.data(), this->length));
+	}
+};
 
 /*
  * Pseudo-file data structures
  *
- * The first structure is mainly so and entire can be loaded at once
- * and then "read" from the vector in this.
+ * The first structure is a cursor over a range of data whose bounds have
+ * already been checked, so that fixed-layout records can be decoded without
+ * checking each value that is read.  Values are copied out with memcpy and
+ * only need their bytes swapped on big-endian hosts.
+ *
+ * The second structure is a non-owning view over data in memory, which can
+ * be "read" from.  Copying a view only copies the pointer and position, so
+ * it is cheap to hand out views of the same data.
  *
- * The second set of structures are wrappers around either an std::ofstream
+ * The third structure is mainly so an entire file can be loaded at once
+ * and then "read" from memory.  When possible, the file is memory-mapped
+ * instead of being read in, otherwise it is read into a vector.  Either
+ * way, the data is never modified once loaded, so copies of the structure
+ * share the same data instead of duplicating it.
+ *
+ * The last set of structures are wrappers around either an std::ofstream
  * or an std::vector of uint8_t to make it easier to write data to it.
  */
 
-struct PseudoReadFile
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+# define SDAT_BIG_ENDIAN_HOST
+#endif
+
+// Convert a value read directly from little endian data into the host's byte order
+template<typename T> inline T FromLE(T val)
 {
-	std::string filename;
-	std::vector<uint8_t> data;
-	uint32_t pos, startOffset;
+#ifdef SDAT_BIG_ENDIAN_HOST
+	uint8_t bytes[sizeof(T)];
+	memcpy(bytes, &val, sizeof(T));
+	std::reverse(bytes, bytes + sizeof(T));
+	memcpy(&val, bytes, sizeof(T));
+#endif
+	return val;
+}
+
+struct PseudoReadCursor
+{
+	const uint8_t *data;
+	size_t size, pos;
+
+	PseudoReadCursor(const uint8_t *cursorData = nullptr, size_t cursorSize = 0) : data(cursorData), size(cursorSize), pos(0)
+	{
+	}
 
-	PseudoReadFile(const std::string &fn = "") : filename(fn), data(), pos(0), startOffset(0)
+	// No bounds checking is done, the cursor's range must cover everything read from it
+	template<typename T> T ReadLE()
 	{
+		T finalVal;
+		memcpy(&finalVal, this->data + this->pos, sizeof(T));
+		this->pos += sizeof(T);
+		return FromLE(finalVal);
 	}
 
-	PseudoReadFile(const PseudoReadFile &file) : filename(file.filename), data(file.data.begin(), file.data.end()), pos(file.pos),
-		startOffset(file.startOffset)
+	template<typename T, size_t N> void ReadLE(T (&arr)[N])
 	{
+		memcpy(&arr[0], this->data + this->pos, sizeof(arr));
+		this->pos += sizeof(arr);
+#ifdef SDAT_BIG_ENDIAN_HOST
+		for (size_t i = 0; i < N; ++i)
+			arr[i] = FromLE(arr[i]);
+#endif
 	}
 
-	PseudoReadFile &operator=(const PseudoReadFile &file)
+	template<typename T> void ReadLE(std::vector<T> &arr)
 	{
-		if (this != &file)
-		{
-			this->filename = file.filename;
-			this->data.assign(file.data.begin(), file.data.end());
-			this->pos = file.pos;
-			this->startOffset = file.startOffset;
-		}
-		return *this;
+		if (arr.empty())
+			return;
+		memcpy(&arr[0], this->data + this->pos, arr.size() * sizeof(T));
+		this->pos += arr.size() * sizeof(T);
+#ifdef SDAT_BIG_ENDIAN_HOST
+		for (size_t i = 0, len = arr.size(); i < len; ++i)
+			arr[i] = FromLE(arr[i]);
+#endif
 	}
 
-	void GetDataFromFile(const std::string &fn)
+	void Skip(size_t bytes)
 	{
-		this->filename = fn;
-		std::ifstream file;
-		file.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-		file.open(fn.c_str(), std::ifstream::in | std::ifstream::binary);
-		this->GetDataFromFile(file);
-		file.close();
+		this->pos += bytes;
 	}
+};
 
-	void GetDataFromFile(std::ifstream &file)
+struct PseudoReadView
+{
+	const uint8_t *data;
+	size_t size;
+	uint32_t pos, startOffset;
+
+	PseudoReadView(const uint8_t *viewData = nullptr, size_t viewSize = 0) : data(viewData), size(viewSize), pos(0), startOffset(0)
 	{
-		auto origPos = file.tellg();
-		file.seekg(0, std::ifstream::end);
-		this->pos = file.tellg();
-		file.seekg(0, std::ifstream::beg);
-		this->data.resize(this->pos);
-		file.read(reinterpret_cast<char *>(&this->data[0]), this->pos);
-		this->pos = this->startOffset = 0;
-		file.seekg(origPos, std::ifstream::beg);
 	}
 
-	template<typename InputIterator> void GetDataFromVector(InputIterator start, InputIterator end)
+	// The vector must outlive the view, as the view does not own the data
+	explicit PseudoReadView(const std::vector<uint8_t> &vec) : data(vec.empty() ? nullptr : &vec[0]), size(vec.size()), pos(0), startOffset(0)
+	{
+	}
+
+	// Same as above, something must keep the bytes alive while the view is in use
+	explicit PseudoReadView(const SharedBytes &bytes) : data(bytes.data()), size(bytes.size()), pos(0), startOffset(0)
 	{
-		this->data.assign(start, end);
-		this->pos = this->startOffset = 0;
+	}
+
+	// Checks that the given number of bytes can be read from the current
+	// position, then returns a cursor over them and moves the position past them
+	PseudoReadCursor GetCursor(size_t length)
+	{
+		if (!length)
+			return PseudoReadCursor();
+		size_t start = static_cast<size_t>(this->startOffset) + this->pos;
+		if (start >= this->size || length > this->size - start)
+			throw std::range_error("PseudoReadView position was set past the end of the data.");
+		this->pos += length;
+		return PseudoReadCursor(this->data + start, length);
 	}
 
 	template<typename T> T ReadLE()
 	{
-		if (this->startOffset + this->pos >= this->data.size() || this->startOffset + this->pos + sizeof(T) > this->data.size())
-			throw std::range_error("PseudoReadFile position was set past the end of the data.");
+		size_t start = static_cast<size_t>(this->startOffset) + this->pos;
+		if (start >= this->size || sizeof(T) > this->size - start)
+			throw std::range_error("PseudoReadView position was set past the end of the data.");
 		T finalVal = 0;
 		for (size_t i = 0; i < sizeof(T); ++i)
-			finalVal |= this->data[this->startOffset + this->pos++] << (i * 8);
+			finalVal |= this->data[start + i] << (i * 8);
+		this->pos += sizeof(T);
 		return finalVal;
 	}
 
@@ -117,9 +250,10 @@ struct PseudoReadFile
 
 	template<size_t N> void ReadLE(uint8_t (&arr)[N])
 	{
-		if (this->startOffset + this->pos >= this->data.size() || this->startOffset + this->pos + N > this->data.size())
-			throw std::range_error("PseudoReadFile position was set past the end of the data.");
-		memcpy(&arr[0], &this->data[this->startOffset + this->pos], N);
+		size_t start = static_cast<size_t>(this->startOffset) + this->pos;
+		if (start >= this->size || N > this->size - start)
+			throw std::range_error("PseudoReadView position was set past the end of the data.");
+		memcpy(&arr[0], &this->data[start], N);
 		this->pos += N;
 	}
 
@@ -131,9 +265,10 @@ struct PseudoReadFile
 
 	void ReadLE(std::vector<uint8_t> &arr)
 	{
-		if (this->startOffset + this->pos >= this->data.size() || this->startOffset + this->pos + arr.size() > this->data.size())
-			throw std::range_error("PseudoReadFile position was set past the end of the data.");
-		memcpy(&arr[0], &this->data[this->startOffset + this->pos], arr.size());
+		size_t start = static_cast<size_t>(this->startOffset) + this->pos;
+		if (start >= this->size || arr.size() > this->size - start)
+			throw std::range_error("PseudoReadView position was set past the end of the data.");
+		memcpy(&arr[0], &this->data[start], arr.size());
 		this->pos += arr.size();
 	}
 
@@ -179,26 +314,139 @@ struct PseudoReadFile
 	{
 		int32_t ret = -1;
 
-		auto offset = std::search(this->data.begin() + startingOffset, this->data.end(), searchBytes.begin(), searchBytes.end());
-		if (offset != this->data.end())
-			ret = offset - this->data.begin();
+		if (startingOffset >= this->size)
+			return ret;
+
+		auto offset = std::search(this->data + startingOffset, this->data + this->size, searchBytes.begin(), searchBytes.end());
+		if (offset != this->data + this->size)
+			ret = offset - this->data;
 
 		return ret;
 	}
 };
 
+struct PseudoReadFile : PseudoReadView
+{
+	std::string filename;
+	// Keeps alive whatever data points into, either a MappedFile or a vector
+	std::shared_ptr<const void> storage;
+
+	PseudoReadFile(const std::string &fn = "") : PseudoReadView(), filename(fn), storage()
+	{
+	}
+
+	void GetDataFromFile(const std::string &fn)
+	{
+		this->filename = fn;
+		auto mappedFile = std::make_shared<MappedFile>();
+		if (mappedFile->Open(fn))
+		{
+			this->data = mappedFile->Data();
+			this->size = mappedFile->Size();
+			this->storage = mappedFile;
+			this->pos = this->startOffset = 0;
+			return;
+		}
+		std::ifstream file;
+		file.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+		file.open(fn.c_str(), std::ifstream::in | std::ifstream::binary);
+		this->GetDataFromFile(file);
+		file.close();
+	}
+
+	void GetDataFromFile(std::ifstream &file)
+	{
+		auto origPos = file.tellg();
+		file.seekg(0, std::ifstream::end);
+		auto vec = std::make_shared<std::vector<uint8_t>>(static_cast<size_t>(file.tellg()));
+		file.seekg(0, std::ifstream::beg);
+		if (!vec->empty())
+			file.read(reinterpret_cast<char *>(&(*vec)[0]), vec->size());
+		this->SetStorage(vec);
+		file.seekg(origPos, std::ifstream::beg);
+	}
+
+	template<typename InputIterator> void GetDataFromVector(InputIterator start, InputIterator end)
+	{
+		this->SetStorage(std::make_shared<std::vector<uint8_t>>(start, end));
+	}
+private:
+	void SetStorage(const std::shared_ptr<std::vector<uint8_t>> &vec)
+	{
+		this->data = vec->empty() ? nullptr : &(*vec)[0];
+		this->size = vec->size();
+		this->storage = vec;
+		this->pos = this->startOffset = 0;
+	}
+};
+
+// Small writes are collected in a buffer and written to the file in large
+// blocks, while blocks at least as large as the buffer are written directly.
+// Flush must be called before the file is closed, the destructor will try to
+// flush any remaining data but can not report if that fails.
+//
+// Instead of a file, the blocks can also be given to an output function, which
+// allows the data to be processed as it is written (such as compressing it).
 struct PseudoWriteFile
 {
-	std::ofstream *file;
+	static const size_t BufferSize = 0x10000;
+
+	typedef std::function<void (const uint8_t *, size_t)> Output;
+
+	Output output;
+	std::vector<uint8_t> buffer;
 
-	PseudoWriteFile(std::ofstream *ofile) : file(ofile)
+	PseudoWriteFile(std::ofstream *ofile) : output([ofile](const uint8_t *data, size_t size) { ofile->write(reinterpret_cast<const char *>(data), size); }), buffer()
 	{
+		this->buffer.reserve(BufferSize);
+	}
+
+	PseudoWriteFile(const Output &newOutput) : output(newOutput), buffer()
+	{
+		this->buffer.reserve(BufferSize);
+	}
+
+	~PseudoWriteFile()
+	{
+		try
+		{
+			this->Flush();
+		}
+		catch (const std::exception &)
+		{
+		}
+	}
+
+	void Flush()
+	{
+		if (!this->buffer.empty())
+		{
+			this->output(&this->buffer[0], this->buffer.size());
+			this->buffer.clear();
+		}
+	}
+
+	void WriteBytes(const void *data, size_t size)
+	{
+		if (this->buffer.size() + size > BufferSize)
+		{
+			this->Flush();
+			if (size >= BufferSize)
+			{
+				this->output(static_cast<const uint8_t *>(data), size);
+				return;
+			}
+		}
+		auto bytes = static_cast<const uint8_t *>(data);
+		this->buffer.insert(this->buffer.end(), bytes, bytes + size);
 	}
 
 	template<typename T> void WriteLE(const T &val)
 	{
+		uint8_t bytes[sizeof(T)];
 		for (size_t i = 0; i < sizeof(T); ++i)
-			this->file->put((val >> (i * 8)) & 0xFF);
+			bytes[i] = (val >> (i * 8)) & 0xFF;
+		this->WriteBytes(bytes, sizeof(T));
 	}
 
 	template<typename T, size_t N> void WriteLE(const T (&arr)[N])
@@ -209,7 +457,7 @@ struct PseudoWriteFile
 
 	template<size_t N> void WriteLE(const uint8_t (&arr)[N])
 	{
-		this->file->write(reinterpret_cast<const char *>(&arr[0]), N);
+		this->WriteBytes(&arr[0], N);
 	}
 
 	template<typename T> void WriteLE(const std::vector<T> &arr)
@@ -220,12 +468,13 @@ struct PseudoWriteFile
 
 	void WriteLE(const std::vector<uint8_t> &arr)
 	{
-		this->file->write(reinterpret_cast<const char *>(&arr[0]), arr.size());
+		if (!arr.empty())
+			this->WriteBytes(&arr[0], arr.size());
 	}
 
 	void WriteLE(const std::string &str, int32_t size = -1)
 	{
-		this->file->write(str.c_str(), size == -1 ? str.size() + 1 : size);
+		this->WriteBytes(str.c_str(), size == -1 ? str.size() + 1 : size);
 	}
 };
 
@@ -237,10 +486,18 @@ struct PseudoWriteVector
 	{
 	}
 
+	void WriteBytes(const void *bytes, size_t size)
+	{
+		auto byteData = static_cast<const uint8_t *>(bytes);
+		this->data.insert(this->data.end(), byteData, byteData + size);
+	}
+
 	template<typename T> void WriteLE(const T &val)
 	{
+		uint8_t bytes[sizeof(T)];
 		for (size_t i = 0; i < sizeof(T); ++i)
-			this->data.push_back((val >> (i * 8)) & 0xFF);
+			bytes[i] = (val >> (i * 8)) & 0xFF;
+		this->data.insert(this->data.end(), bytes, bytes + sizeof(T));
 	}
 
 	template<typename T, size_t N> void WriteLE(const T (&arr)[N])
@@ -267,10 +524,8 @@ struct PseudoWriteVector
 
 	void WriteLE(const std::string &str, int32_t size = -1)
 	{
-		size_t finalSize = size == -1 ? str.size() + 1 : size;
-		auto strData = std::vector<uint8_t>(finalSize, 0);
-		memcpy(&strData[0], str.c_str(), finalSize);
-		this->data.insert(this->data.end(), strData.begin(), strData.end());
+		auto strData = reinterpret_cast<const uint8_t *>(str.c_str());
+		this->data.insert(this->data.end(), strData, strData + (size == -1 ? str.size() + 1 : size));
 	}
 };
 
@@ -294,6 +549,25 @@ struct PseudoWrite
 	{
 	}
 
+	PseudoWrite(const PseudoWriteFile::Output &output) : file(new PseudoWriteFile(output)), vector(), type(PSEUDOWRITE_FILE)
+	{
+	}
+
+	// Only has an effect when writing to a vector, lets the vector be allocated
+	// once when the final size is known ahead of time
+	void Reserve(size_t size)
+	{
+		if (type == PSEUDOWRITE_VECTOR)
+			this->vector->data.reserve(this->vector->data.size() + size);
+	}
+
+	// Only needed when writing to a file, see PseudoWriteFile
+	void Flush()
+	{
+		if (type == PSEUDOWRITE_FILE)
+			this->file->Flush();
+	}
+
 	template<typename T> void WriteLE(const T &val)
 	{
 		if (type == PSEUDOWRITE_FILE)
@@ -341,6 +615,14 @@ struct PseudoWrite
 		else
 			this->vector->WriteLE(str, size);
 	}
+
+	void WriteLE(const SharedBytes &bytes)
+	{
+		if (type == PSEUDOWRITE_FILE)
+			this->file->WriteBytes(bytes.data(), bytes.size());
+		else
+			this->vector->WriteBytes(bytes.data(), bytes.size());
+	}
 };
 
 /*
@@ -457,8 +739,11 @@ inline bool FileExists(const std::string &filename)
 /*
  * Wildcard matching code by M Shahid Shafiq, from:
  * http://www.codeproject.com/Articles/19694/String-Wildcard-Matching-and
+ *
+ * Characters are compared after being passed through fold, so the same
+ * matching can be done on strings that were already uppercased.
  */
-inline bool WildcardCompare(const std::string &tameText, const std::string &wildText)
+template<typename F> inline bool WildcardCompare(const char *str, const char *pattern, F fold)
 {
 	enum State
 	{
@@ -467,8 +752,6 @@ inline bool WildcardCompare(const std::string &tameText, const std::string &wild
 		AnyRepeat // *
 	};
 
-	const char *str = tameText.c_str();
-	const char *pattern = wildText.c_str();
 	const char *q = nullptr;
 	State state = Exact;
 
@@ -491,7 +774,7 @@ inline bool WildcardCompare(const std::string &tameText, const std::string &wild
 		switch (state)
 		{
 			case Exact:
-				match = std::toupper(*str) == std::toupper(*pattern);
+				match = fold(*str) == fold(*pattern);
 				++str;
 				++pattern;
 				break;
@@ -506,17 +789,28 @@ inline bool WildcardCompare(const std::string &tameText, const std::string &wild
 				match = true;
 				++str;
 
-				if (std::toupper(*str) == std::toupper(*q))
+				if (fold(*str) == fold(*q))
 					++pattern;
 		}
 	}
 
 	if (state == AnyRepeat)
-		return std::toupper(*str) == std::toupper(*q);
+		return fold(*str) == fold(*q);
 	else if (state == Any)
-		return std::toupper(*str) == std::toupper(*pattern);
+		return fold(*str) == fold(*pattern);
 	else
-		return match && std::toupper(*str) == std::toupper(*pattern);
+		return match && fold(*str) == fold(*pattern);
+}
+
+inline bool WildcardCompare(const std::string &tameText, const std::string &wildText)
+{
+	return WildcardCompare(tameText.c_str(), wildText.c_str(), [](char c) { return std::toupper(c); });
+}
+
+inline std::string ToUpper(std::string text)
+{
+	std::transform(text.begin(), text.end(), text.begin(), [](char c) { return static_cast<char>(std::toupper(c)); });
+	return text;
 }
 
 // The following are for handling a vector of included or excluded files
@@ -539,24 +833,138 @@ struct KeepInfo
 
 typedef std::vector<KeepInfo> IncOrExc;
 
-inline KeepType IncludeFilename(const std::string &filename, const std::string &sdatNumber, const IncOrExc &includesAndExcludes)
+/*
+ * The rules of an IncOrExc, prepared once so many filenames can be checked
+ * against them.  Each rule is split into its SDAT number and filename and
+ * uppercased ahead of time.  Rules without wildcards (such as the ones from an
+ * SMAP) are looked up by name, so only the rules with wildcards have to be
+ * checked one by one.  Patterns whose only wildcard is a * at the end are
+ * compared as prefixes, as WildcardCompare would give the same result for
+ * them.  When more than 1 rule matches a filename, the last one wins.
+ */
+class KeepMatcher
 {
-	KeepType keep = KEEP_NEITHER;
-	std::for_each(includesAndExcludes.begin(), includesAndExcludes.end(), [&](const KeepInfo &info)
+	enum PatternType
 	{
-		size_t slash = info.filename.find('/');
-		if (slash != std::string::npos)
+		PATTERN_EXACT,
+		PATTERN_PREFIX,
+		PATTERN_WILDCARD
+	};
+
+	struct Pattern
+	{
+		std::string text;
+		PatternType type;
+
+		Pattern(const std::string &pattern = "") : text(ToUpper(pattern)), type(PATTERN_EXACT)
 		{
-			std::string currSDATNumber = info.filename.substr(0, slash);
-			std::string currFilename = info.filename.substr(slash + 1);
-			if (WildcardCompare(sdatNumber, currSDATNumber) && WildcardCompare(filename, currFilename))
-				keep = info.keep;
+			size_t wildcard = this->text.find_first_of("*?");
+			if (wildcard == std::string::npos)
+				return;
+			if (wildcard == this->text.size() - 1 && this->text[wildcard] == '*')
+			{
+				this->type = PATTERN_PREFIX;
+				this->text.erase(wildcard);
+			}
+			else
+				this->type = PATTERN_WILDCARD;
 		}
-		else if (WildcardCompare(filename, info.filename))
-			keep = info.keep;
-	});
-	return keep;
-}
+
+		// The text must already be uppercased
+		bool Matches(const std::string &upperText) const
+		{
+			switch (this->type)
+			{
+				case PATTERN_EXACT:
+					return upperText == this->text;
+				case PATTERN_PREFIX:
+					return !upperText.compare(0, this->text.size(), this->text);
+				default:
+					return WildcardCompare(upperText.c_str(), this->text.c_str(), [](char c) { return c; });
+			}
+		}
+	};
+
+	struct Rule
+	{
+		size_t number;
+		bool hasSDATNumber;
+		Pattern sdatNumber, filename;
+
+		Rule(size_t ruleNumber, const std::string &rule) : number(ruleNumber), hasSDATNumber(false), sdatNumber(), filename()
+		{
+			size_t slash = rule.find('/');
+			if (slash != std::string::npos)
+			{
+				this->hasSDATNumber = true;
+				this->sdatNumber = Pattern(rule.substr(0, slash));
+				this->filename = Pattern(rule.substr(slash + 1));
+			}
+			else
+				this->filename = Pattern(rule);
+		}
+	};
+
+	typedef std::unordered_map<std::string, size_t> ExactRules;
+
+	std::vector<KeepType> keeps;
+	ExactRules exactRules;
+	std::unordered_map<std::string, ExactRules> exactSDATRules;
+	std::vector<Rule> otherRules;
+public:
+	KeepMatcher(const IncOrExc &includesAndExcludes = IncOrExc()) : keeps(), exactRules(), exactSDATRules(), otherRules()
+	{
+		this->keeps.reserve(includesAndExcludes.size());
+		std::for_each(includesAndExcludes.begin(), includesAndExcludes.end(), [&](const KeepInfo &info) { this->Add(info); });
+	}
+
+	// Should be called for every rule added to the IncOrExc after the matcher was made
+	void Add(const KeepInfo &info)
+	{
+		Rule rule(this->keeps.size(), info.filename);
+		this->keeps.push_back(info.keep);
+		if (rule.filename.type != PATTERN_EXACT || (rule.hasSDATNumber && rule.sdatNumber.type != PATTERN_EXACT))
+			this->otherRules.push_back(rule);
+		else if (rule.hasSDATNumber)
+			this->exactSDATRules[rule.sdatNumber.text][rule.filename.text] = rule.number;
+		else
+			this->exactRules[rule.filename.text] = rule.number;
+	}
+
+	KeepType Match(const std::string &filename, const std::string &sdatNumber) const
+	{
+		if (this->keeps.empty())
+			return KEEP_NEITHER;
+		std::string upperFilename = ToUpper(filename), upperSDATNumber = ToUpper(sdatNumber);
+
+		// Find the last of the rules without wildcards that matches
+		size_t lastMatch = std::string::npos;
+		auto exactRule = this->exactRules.find(upperFilename);
+		if (exactRule != this->exactRules.end())
+			lastMatch = exactRule->second;
+		auto SDATRules = this->exactSDATRules.find(upperSDATNumber);
+		if (SDATRules != this->exactSDATRules.end())
+		{
+			exactRule = SDATRules->second.find(upperFilename);
+			if (exactRule != SDATRules->second.end() && (lastMatch == std::string::npos || exactRule->second > lastMatch))
+				lastMatch = exactRule->second;
+		}
+
+		// Then only the rules with wildcards that came after it need to be checked
+		for (auto rule = this->otherRules.rbegin(); rule != this->otherRules.rend(); ++rule)
+		{
+			if (lastMatch != std::string::npos && rule->number < lastMatch)
+				break;
+			if ((!rule->hasSDATNumber || rule->sdatNumber.Matches(upperSDATNumber)) && rule->filename.Matches(upperFilename))
+			{
+				lastMatch = rule->number;
+				break;
+			}
+		}
+
+		return lastMatch != std::string::npos ? this->keeps[lastMatch] : KEEP_NEITHER;
+	}
+};
 
 // Check if the directory exists
 inline bool DirExists(const std::string &dirName)